@@ -0,0 +1,72 @@
+// Latency from a pin edge to the timecontrol callback, immediate and deferred.
+// Wire OUTPUT_PIN to INTERRUPT_PIN with a jumper.
+#include "timecontrol.h"
+
+const uint8_t OUTPUT_PIN = 3;
+const uint8_t INTERRUPT_PIN = 2;
+const uint8_t SAMPLES = 100;
+
+timecontrol edge(0x7FFFFFFF);  // Driven by the pin only
+
+volatile uint32_t edgeTime = 0;
+volatile uint32_t callbackTime = 0;
+
+void onEdge() {
+  callbackTime = micros();
+}
+
+uint32_t measure() {
+  uint32_t total = 0;
+  uint32_t worst = 0;
+  uint8_t received = 0;
+  uint8_t timeouts = 0;
+  for (uint8_t i = 0; i < SAMPLES; i++) {
+    callbackTime = 0;
+    digitalWrite(OUTPUT_PIN, LOW);
+    delayMicroseconds(50);
+    edgeTime = micros();
+    digitalWrite(OUTPUT_PIN, HIGH);
+    uint32_t start = millis();
+    while (callbackTime == 0 && millis() - start < 10) timecontrol::processInterrupts();
+    if (callbackTime == 0) {
+      timeouts++;  // No callback: not a latency sample
+      continue;
+    }
+    uint32_t latency = callbackTime - edgeTime;
+    total += latency;
+    received++;
+    if (latency > worst) worst = latency;
+  }
+  uint32_t mean = (received > 0) ? total / received : 0;
+  Serial.print(mean);
+  Serial.print(" us mean, ");
+  Serial.print(worst);
+  Serial.print(" us worst, ");
+  Serial.print(timeouts);
+  Serial.println(" timed out");
+  return mean;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+  pinMode(OUTPUT_PIN, OUTPUT);
+  pinMode(INTERRUPT_PIN, INPUT);
+  edge.setCallback(onEdge);
+
+  if (!edge.attachInterrupt(INTERRUPT_PIN, RISING)) {
+    Serial.println("INTERRUPT_PIN has no interrupt on this board");
+    return;
+  }
+  Serial.print("Immediate (callback in the ISR): ");
+  measure();
+
+  edge.detachInterrupt();
+  edge.attachInterrupt(INTERRUPT_PIN, RISING, true);
+  Serial.print("Deferred (callback from processInterrupts()): ");
+  measure();
+  Serial.print("Dropped events: ");
+  Serial.println(timecontrol::getInterruptOverflows());
+}
+
+void loop() {}
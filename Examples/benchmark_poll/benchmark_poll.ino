@@ -0,0 +1,95 @@
+// Cost of the polled hot paths, the formatter and the RAM per timer configuration.
+// Run it before and after upgrading the library: regressions show up as numbers.
+#include "timecontrol.h"
+#include "basic_timecontrol.h"
+#include "timescheduler.h"
+
+const uint16_t ITERATIONS = 10000;
+
+volatile uint32_t sink = 0;  // Keeps the measured calls from being optimized away
+uint32_t baseline = 0;       // Loop overhead in microseconds, subtracted from every result
+
+void countFire() {
+  sink++;
+}
+
+void report(const char* label, uint32_t micros) {
+  uint32_t net = (micros > baseline) ? micros - baseline : 0;
+  Serial.print(label);
+  Serial.print(": ");
+  Serial.print((float)net * 1000.0 / ITERATIONS, 1);
+  Serial.print(" ns/call");
+#if defined(F_CPU)
+  Serial.print(", ");
+  Serial.print((float)net * (F_CPU / 1000000.0) / ITERATIONS, 1);
+  Serial.print(" cycles/call");
+#endif
+  Serial.println();
+}
+
+void reportSize(const char* label, size_t bytes) {
+  Serial.print("sizeof(");
+  Serial.print(label);
+  Serial.print("): ");
+  Serial.println((uint32_t)bytes);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += i;
+  baseline = micros() - start;
+
+  timecontrol idle(0x7FFFFFFF);   // Not due for 24 days: the cost of a poll that finds nothing due
+  uint32_t now = millis();
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += idle.elapsed(now);
+  report("elapsed(now), idle", micros() - start);
+
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += idle.elapsed();
+  report("elapsed(), idle", micros() - start);
+
+  timecontrol busy(0);            // Fires on every poll: bookkeeping, history and callback
+  busy.setCallback(countFire);
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += busy.elapsed(now);
+  report("elapsed(now), firing", micros() - start);
+
+  timecontrol idleSeconds(3600000);
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += idleSeconds.elapsedSeconds();
+  report("elapsedSeconds(), idle", micros() - start);
+
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += idle.elapsedMicros();
+  report("elapsedMicros(), idle", micros() - start);
+
+  timecontrol_lite lite(0x7FFFFFFF);
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) sink += lite.elapsed(now);
+  report("timecontrol_lite elapsed(now), idle", micros() - start);
+
+  char text[TIMECONTROL_TIME_STRING_SIZE];
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    timecontrol::secToTime(100000UL + i, text, sizeof(text));
+    sink += text[7];
+  }
+  report("secToTime(sec, buffer, size)", micros() - start);
+
+  reportSize("timecontrol", sizeof(timecontrol));
+  reportSize("timecontrol_lite", sizeof(timecontrol_lite));
+  reportSize("basic_timecontrol<CALLBACKS, 0>", sizeof(basic_timecontrol<TIMECONTROL_FEATURE_CALLBACKS, 0>));
+  reportSize("basic_timecontrol<REPEAT | TOTAL, 0>", 
+             sizeof(basic_timecontrol<TIMECONTROL_FEATURE_REPEAT | TIMECONTROL_FEATURE_TOTAL, 0>));
+  reportSize("basic_timecontrol<ALL, 8>", sizeof(basic_timecontrol<TIMECONTROL_FEATURE_ALL, 8>));
+  reportSize("basic_timecontrol<ALL, 16>", sizeof(basic_timecontrol<TIMECONTROL_FEATURE_ALL, 16>));
+  reportSize("timescheduler<8>", sizeof(timescheduler<8>));
+  reportSize("timescheduler<32>", sizeof(timescheduler<32>));
+  reportSize("timedelegate", sizeof(timedelegate));
+}
+
+void loop() {}
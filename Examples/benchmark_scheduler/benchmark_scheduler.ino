@@ -0,0 +1,82 @@
+// Cost of timescheduler::tick() for N registered timers, against polling them one by one.
+// N doubles up to MAX_TIMERS (bounded by RAM and by the 254-timer scheduler capacity).
+#include "timescheduler.h"
+
+#if defined(__AVR__) && RAMEND < 0x1000
+const uint8_t MAX_TIMERS = 8;     // ATmega328P and smaller: 2 KB of RAM
+#elif defined(__AVR__)
+const uint8_t MAX_TIMERS = 32;
+#else
+#if defined(ESP32) || defined(ARDUINO_ARCH_RP2040) || !defined(ARDUINO)
+const uint32_t RAM_BUDGET = 131072;  // Hundreds of KB of RAM
+#else
+const uint32_t RAM_BUDGET = 16384;   // SAMD21 and other 32 KB parts: half of the RAM
+#endif
+const uint32_t TIMER_COST = sizeof(timecontrol) + 3 * sizeof(timecontrol*);  // Timer, plus slot, heap and due entries
+const uint8_t MAX_TIMERS = (RAM_BUDGET / TIMER_COST < 254) ? RAM_BUDGET / TIMER_COST : 254;
+#endif
+
+const uint16_t TICKS = 1000;
+
+timecontrol timers[MAX_TIMERS];
+timescheduler<MAX_TIMERS> scheduler;
+
+volatile uint32_t sink = 0;
+
+void countFire() {
+  sink++;
+}
+
+float nsPer(uint32_t micros, uint32_t calls) {
+  return (float)micros * 1000.0 / calls;
+}
+
+void printRow(uint8_t count, uint32_t idleTick, uint32_t idlePoll, uint32_t busyTick) {
+  Serial.print(count);
+  Serial.print('\t');
+  Serial.print(nsPer(idleTick, TICKS), 0);
+  Serial.print('\t');
+  Serial.print(nsPer(idlePoll, TICKS), 0);
+  Serial.print('\t');
+  Serial.println(nsPer(busyTick, (uint32_t)TICKS * count), 0);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+  for (uint8_t i = 0; i < MAX_TIMERS; i++) timers[i].setCallback(countFire);
+
+  Serial.println("N\ttick idle (ns)\tpoll all idle (ns)\ttick firing (ns per timer)");
+  uint16_t count = 1;
+  while (true) {
+    uint8_t n = (count < MAX_TIMERS) ? count : MAX_TIMERS;
+    for (uint8_t i = 0; i < n; i++) {
+      timers[i].setTimelapse(0x7FFFFFFF);  // Armed, not due for 24 days
+      timers[i].reset();
+      scheduler.add(timers[i]);
+    }
+
+    uint32_t now = millis();
+    uint32_t start = micros();
+    for (uint16_t t = 0; t < TICKS; t++) sink += scheduler.tick(now);
+    uint32_t idleTick = micros() - start;
+
+    start = micros();
+    for (uint16_t t = 0; t < TICKS; t++) {
+      for (uint8_t i = 0; i < n; i++) sink += timers[i].elapsed(now);
+    }
+    uint32_t idlePoll = micros() - start;
+
+    for (uint8_t i = 0; i < n; i++) timers[i].setTimelapse(0);  // Due on every tick
+    start = micros();
+    for (uint16_t t = 0; t < TICKS; t++) sink += scheduler.tick();
+    uint32_t busyTick = micros() - start;
+
+    printRow(n, idleTick, idlePoll, busyTick);
+    for (uint8_t i = 0; i < n; i++) scheduler.remove(timers[i]);
+    if (n == MAX_TIMERS) break;
+    count *= 2;
+  }
+}
+
+void loop() {}
@@ -0,0 +1,20 @@
+#include "timedebouncer.h"
+
+// Eight buttons to ground on pins 2..9, debounced by one 5 ms timer instead of eight.
+timedebouncer8 buttons(5);
+
+void onButton(uint8_t id, bool pressed) {
+  Serial.print("Button ");
+  Serial.print(id);
+  Serial.println(pressed ? " pressed" : " released");
+}
+
+void setup() {
+  Serial.begin(9600);
+  for (uint8_t id = 0; id < 8; id++) buttons.attach(id, 2 + id);  // INPUT_PULLUP, active low
+  buttons.setCallback(onButton);
+}
+
+void loop() {
+  buttons.update();  // Samples all eight pins every 5 ms; edges after 20 ms of stable level
+}
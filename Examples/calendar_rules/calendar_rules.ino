@@ -0,0 +1,53 @@
+#include "timecalendar.h"
+#include "timescheduler.h"
+
+// Calendar rules on a sleeping scheduler. The clock is set from the serial port:
+// send "T" followed by the Unix time, e.g. T1700000000 (from `date +%s`).
+// An RTC, NTP or GPS would call calendar.sync() the same way.
+timescheduler<3> scheduler;
+timecalendar<3> calendar;
+timecontrol sampleTimer;
+timecontrol reportTimer;
+timecontrol weeklyTimer;
+
+uint8_t sampleRule;
+uint8_t reportRule;
+uint8_t weeklyRule;
+
+void printClock(uint32_t time) {
+  timecontrol::printTime(Serial, time % SECONDS_PER_DAY);  // Local time of day
+}
+
+void onRule(uint8_t id, uint32_t time) {
+  printClock(time);
+  if (id == sampleRule) Serial.println(" Sample (every 15 min)");
+  if (id == reportRule) Serial.println(" Daily report (02:00)");
+  if (id == weeklyRule) Serial.println(" Weekly maintenance (Sunday 09:30)");
+}
+
+void readClock() {
+  if (Serial.available() == 0 || Serial.read() != 'T') return;
+  uint32_t unixTime = Serial.parseInt();
+  calendar.sync(unixTime);  // Re-arms every rule from the corrected clock
+  Serial.print("Synced, next sample at ");
+  printClock(calendar.nextOccurrence(sampleRule));
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(9600);
+  scheduler.add(sampleTimer);
+  scheduler.add(reportTimer);
+  scheduler.add(weeklyTimer);
+  calendar.setCallback(onRule);
+  calendar.setUtcOffset(3600);  // UTC+1
+  sampleRule = calendar.every(sampleTimer, 15 * SECONDS_PER_MINUTE);
+  reportRule = calendar.daily(reportTimer, 2, 0);
+  weeklyRule = calendar.weekly(weeklyTimer, 0, 9, 30);
+}
+
+void loop() {
+  readClock();
+  scheduler.tick();
+  scheduler.idle();  // Sleeps until the next rule (or a serial interrupt)
+}
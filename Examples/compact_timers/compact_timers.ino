@@ -0,0 +1,34 @@
+#include "basic_timecontrol.h"
+
+// 13 bytes each on AVR: no callbacks, no history, no micros, no total time
+timecontrol_lite channels[8] = {100, 150, 200, 250, 300, 350, 400, 450};
+
+// Callbacks and repetitions only, no history
+basic_timecontrol<TIMECONTROL_FEATURE_CALLBACKS | TIMECONTROL_FEATURE_REPEAT, 0> blinkTimer(250);
+
+void blink() {
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(LED_BUILTIN, OUTPUT);
+  blinkTimer.setCallback(blink);
+  blinkTimer.setRepeatCount(20);  // 10 blinks
+
+  Serial.print("sizeof(timecontrol_lite): ");
+  Serial.println(sizeof(timecontrol_lite));
+  Serial.print("sizeof(blinkTimer): ");
+  Serial.println(sizeof(blinkTimer));
+}
+
+void loop() {
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < 8; i++) {
+    if (channels[i].elapsed(now)) {
+      Serial.print("Channel ");
+      Serial.println(i);
+    }
+  }
+  blinkTimer.elapsed(now);
+}
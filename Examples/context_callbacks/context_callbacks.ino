@@ -0,0 +1,39 @@
+#include "timecontrol.h"
+
+// One structure per LED channel instead of one callback function per LED.
+struct channel {
+  uint8_t pin;
+  uint16_t toggles;
+
+  void toggle() {
+    digitalWrite(pin, !digitalRead(pin));
+    toggles++;
+  }
+};
+
+channel channels[] = {{3, 0}, {5, 0}, {6, 0}};
+timecontrol blinkers[] = {{250}, {400}, {650}};
+timecontrol report(2000);
+
+void printReport(void* context, uint32_t) {
+  channel* list = static_cast<channel*>(context);
+  for (uint8_t i = 0; i < 3; i++) {
+    Serial.print(list[i].pin);
+    Serial.print(": ");
+    Serial.println(list[i].toggles);
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+  for (uint8_t i = 0; i < 3; i++) {
+    pinMode(channels[i].pin, OUTPUT);
+    blinkers[i].setCallback(timedelegate::bind<channel, &channel::toggle>(channels[i]));
+  }
+  report.setCallback(printReport, channels);
+}
+
+void loop() {
+  for (uint8_t i = 0; i < 3; i++) blinkers[i].elapsed();
+  report.elapsed();
+}
@@ -0,0 +1,63 @@
+#include "timescheduler.h"
+
+// Deep-sleeps between deadlines without losing the timers' phase, counts and history.
+// On ESP32 the state lives in RTC memory; elsewhere delay() stands in for the sleep.
+const uint32_t MIN_SLEEP = 2000;  // Shorter waits are not worth a reboot
+
+timescheduler<2> scheduler;
+timecontrol sampleTask(15000);    // Reads a sensor every 15 seconds
+timecontrol uploadTask(60000);    // Sends the readings every minute
+
+#if defined(ESP32)
+RTC_DATA_ATTR timestate saved[2];  // Survives deep sleep, zero on a cold boot
+RTC_DATA_ATTR uint64_t sleptMicros = 0;
+#else
+timestate saved[2];
+uint64_t sleptMicros = 0;
+#endif
+
+void sample() {
+  Serial.print("Sample #");
+  Serial.println(sampleTask.elapsedCount());
+}
+
+void upload() {
+  Serial.print("Upload, ");
+  Serial.print(uploadTask.getTotalElapsedTime());
+  Serial.println(" ms since the first boot");
+}
+
+void deepSleep(uint32_t duration) {
+  sampleTask.save(saved[0]);
+  uploadTask.save(saved[1]);
+  sleptMicros = (uint64_t)duration * 1000;
+  Serial.flush();
+#if defined(ESP32)
+  esp_sleep_enable_timer_wakeup(sleptMicros);
+  esp_deep_sleep_start();      // Restarts in setup()
+#else
+  delay(duration);             // Board-specific sleep here
+  sampleTask.restore(saved[0], 0);  // millis() kept counting: nothing to rebase
+  uploadTask.restore(saved[1], 0);
+#endif
+}
+
+void setup() {
+  Serial.begin(115200);
+  sampleTask.setCallback(sample);
+  uploadTask.setCallback(upload);
+  // Callbacks and registration are code: set them up first, then bring the state back
+  if (sampleTask.restore(saved[0], sleptMicros) && uploadTask.restore(saved[1], sleptMicros)) {
+    Serial.println("Resumed");
+  } else {
+    Serial.println("Cold boot");
+  }
+  scheduler.add(sampleTask);
+  scheduler.add(uploadTask);
+}
+
+void loop() {
+  scheduler.tick();
+  uint32_t wait = scheduler.nextDeadline();
+  if (wait >= MIN_SLEEP) deepSleep(wait);
+}
@@ -4,6 +4,7 @@ timecontrol interruptTimer;  // No timelapse, used for interrupts
 const int BUTTON_PIN = 2;    // Interrupt pin 
 
 void countEvent() {
+  // Runs from loop() (deferred mode), so Serial is safe here
   Serial.print("Event detected, count: ");
   Serial.println(interruptTimer.elapsedCount());
 }
@@ -12,10 +13,19 @@ void setup() {
   Serial.begin(9600);
   pinMode(BUTTON_PIN, INPUT_PULLUP);
   interruptTimer.setCallback(countEvent);
-  interruptTimer.attachInterrupt(BUTTON_PIN, FALLING);  // Interrupt on falling edge
+  interruptTimer.attachInterrupt(BUTTON_PIN, FALLING, true);  // Interrupt on falling edge, deferred callback
   Serial.println("Counting with interrupt");
 }
 
 void loop() {
-  // Nothing in loop, handled by interrupt
+  // The ISR only queues the event; callbacks run here
+  timecontrol::processInterrupts();
+
+  static uint16_t reportedOverflows = 0;
+  uint16_t overflows = timecontrol::getInterruptOverflows();
+  if (overflows != reportedOverflows) {
+    reportedOverflows = overflows;
+    Serial.print("Events dropped (queue full): ");
+    Serial.println(overflows);
+  }
 }
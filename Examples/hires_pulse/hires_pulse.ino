@@ -0,0 +1,39 @@
+#include "timehires.h"
+
+const uint8_t PULSE_PIN = 9;
+
+timecontrol pulse(250);          // Toggles PULSE_PIN every 250 microseconds
+timecontrol report(1000000UL);   // Reports once per second (also in microseconds)
+
+volatile uint32_t toggles = 0;
+
+void togglePulse() {
+  digitalWrite(PULSE_PIN, !digitalRead(PULSE_PIN));
+  toggles++;
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(PULSE_PIN, OUTPUT);
+
+  pulse.setCallback(togglePulse);
+  timehires::add(pulse);
+  if (timehires::begin()) {
+    Serial.println("Hardware compare-match backend");
+  } else {
+    Serial.println("No backend for this board, polling");
+  }
+}
+
+void loop() {
+  timehires::poll();             // Does nothing when the hardware backend runs
+
+  if (report.elapsedMicros()) {
+    noInterrupts();
+    uint32_t count = toggles;
+    toggles = 0;
+    interrupts();
+    Serial.print("Toggles per second: ");
+    Serial.println(count);       // 4000 even while the loop is busy printing
+  }
+}
@@ -0,0 +1,50 @@
+#include "timestopwatch.h"
+#include "timescheduler.h"
+
+// A button on pin 2 records laps; a 60 s session countdown ends the run.
+// The stopwatch and the countdown are passive: only the completion timer
+// is in the scheduler, so idle() sleeps until the next button edge or expiry.
+// The button is not debounced here (see timedebouncer).
+const uint8_t LAP_PIN = 2;
+
+timescheduler<1> scheduler;
+timestopwatch race;
+timecountdown session(60000UL);
+timecontrol sessionEnd(0, false, 0);  // One-shot armed by wakeAtExpiry()
+timecontrol lapButton(0, false, 0);   // Deferred interrupt only, drained by tick()
+
+void onLap() {
+  if (!session.isRunning()) return;
+  Serial.print("Lap ");
+  Serial.print(race.lap());
+  Serial.print(" ms, total ");
+  Serial.print(race.split());
+  Serial.print(" ms, ");
+  Serial.print(session.remaining() / 1000);
+  Serial.println(" s left");
+}
+
+void onSessionEnd() {
+  race.stop();
+  Serial.print("Session over, last lap ");
+  Serial.print(race.currentLap());
+  Serial.println(" ms");
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(LAP_PIN, INPUT_PULLUP);
+  sessionEnd.setCallback(onSessionEnd);
+  lapButton.setCallback(onLap);
+  lapButton.attachInterrupt(LAP_PIN, FALLING, true);
+  scheduler.add(sessionEnd);
+
+  race.start();
+  session.start();
+  session.wakeAtExpiry(sessionEnd);
+}
+
+void loop() {
+  scheduler.tick();
+  scheduler.idle();
+}
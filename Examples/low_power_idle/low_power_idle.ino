@@ -0,0 +1,32 @@
+#include "timescheduler.h"
+
+timescheduler<2> scheduler;
+
+timecontrol ledTask(1000);    // Blinks LED every second
+timecontrol sensorTask(5000); // Reads a sensor every 5 seconds
+
+void blinkLED() {
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+void readSensor() {
+  Serial.print("Sensor: ");
+  Serial.println(analogRead(A0));
+  Serial.flush();  // Finish sending before the CPU goes back to sleep
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  ledTask.setCallback(blinkLED);
+  sensorTask.setCallback(readSensor);
+  scheduler.add(ledTask);
+  scheduler.add(sensorTask);
+  Serial.println("Sleeping between deadlines");
+}
+
+void loop() {
+  scheduler.tick();
+  scheduler.idle();  // Sleeps until the next deadline (pass true for tickless sleep on ESP32)
+}
@@ -0,0 +1,58 @@
+#include "timescheduler.h"
+
+// Two timer groups: "sampling" runs on its own core (ESP32 task or RP2040 core 1),
+// "ui" runs in loop(). loop() never touches a sampling timer directly: it posts commands.
+timescheduler<2> sampling;
+timescheduler<1> ui;
+
+timecontrol sampleTask(20);    // 50 Hz sampling
+timecontrol reportTask(1000);
+timecontrol rateTask(5000);    // Changes the sampling rate every 5 seconds
+
+volatile uint32_t samples = 0;
+bool fast = false;
+
+void sample() {
+  samples++;                   // analogRead(), filtering...
+}
+
+void report() {
+  Serial.print("Samples: ");
+  Serial.println(samples);
+}
+
+void changeRate() {
+  fast = !fast;
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+  sampling.post(sampleTask, CommandSetTimelapse, fast ? 5 : 20);  // Applied by the sampling core
+#else
+  sampleTask.setTimelapse(fast ? 5 : 20);                         // AVR: same core, no queue
+#endif
+}
+
+void setup() {
+  Serial.begin(115200);
+  sampleTask.setCallback(sample);
+  reportTask.setCallback(report);
+  rateTask.setCallback(changeRate);
+  sampling.add(sampleTask);
+  sampling.add(reportTask);
+  ui.add(rateTask);
+#if defined(ESP32)
+  sampling.runOnCore(0);       // loop() runs on core 1
+#endif
+}
+
+void loop() {
+  ui.tick();
+#if !defined(ESP32) && !defined(ARDUINO_ARCH_RP2040)
+  sampling.tick();             // Single core: both groups in loop()
+#endif
+}
+
+#if defined(ARDUINO_ARCH_RP2040)
+void loop1() {                 // Second core
+  sampling.tick();
+  sampling.idle();
+}
+#endif
@@ -0,0 +1,38 @@
+#include "timebucket.h"
+#include "timescheduler.h"
+
+// Sensor readings every 200 ms, but the radio link allows bursts of 3 messages
+// and 1 message per 2 seconds on average. Excess readings are counted, not sent.
+timescheduler<2> scheduler;
+timecontrol sampleTask(200);
+timecontrol flushTask(0, false, 0);  // One-shot wake when the link frees up
+timebucket radio(3, 2000);
+
+uint32_t pending = 0;
+
+void send() {
+  while (pending > 0 && radio.tryAcquire()) {
+    Serial.print("Send, ");
+    Serial.print(--pending);
+    Serial.println(" pending");
+  }
+  if (pending > 0) radio.wakeWhenAvailable(flushTask);  // idle() wakes exactly then
+}
+
+void sample() {
+  pending++;
+  send();
+}
+
+void setup() {
+  Serial.begin(9600);
+  sampleTask.setCallback(sample);
+  flushTask.setCallback(send);
+  scheduler.add(sampleTask);
+  scheduler.add(flushTask);
+}
+
+void loop() {
+  scheduler.tick();
+  scheduler.idle();
+}
@@ -0,0 +1,40 @@
+#include "timescheduler.h"
+
+timescheduler<4> scheduler;  // Room for up to 4 timers
+
+timecontrol ledTask(500);     // Blinks LED every 500 ms
+timecontrol reportTask(2000); // Message every 2 seconds
+timecontrol sampleTask(100);  // Reads an analog input every 100 ms
+
+uint16_t lastSample = 0;
+
+void blinkLED() {
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+void report() {
+  Serial.print("Last sample: ");
+  Serial.println(lastSample);
+}
+
+void sample() {
+  lastSample = analogRead(A0);
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  ledTask.setCallback(blinkLED);
+  reportTask.setCallback(report);
+  sampleTask.setCallback(sample);
+
+  scheduler.add(ledTask);
+  scheduler.add(reportTask);
+  scheduler.add(sampleTask);
+  Serial.println("Three tasks driven by one scheduler");
+}
+
+void loop() {
+  scheduler.tick();  // One millis() read for all registered timers
+}
@@ -0,0 +1,39 @@
+#include "timecounter.h"
+
+// Fan tachometer (2 pulses per revolution) on pin 2 and flow meter on pin 3.
+// The ISRs only count edges; each one-second period of the timers is the gate.
+const uint8_t TACH_PIN = 2;
+const uint8_t FLOW_PIN = 3;
+const float FLOW_PULSES_PER_LITRE = 450.0f;  // Sensor K-factor
+
+timecounter tach(true);          // Reciprocal: slow fans still read to a fraction of an RPM
+timecounter flow;                // Gate: one increment per edge at several kHz
+timecontrol tachGate(1000);
+timecontrol flowGate(1000);
+
+void printRPM() {
+  Serial.print("Fan: ");
+  Serial.print(tach.getRPM(2), 1);
+  Serial.println(" RPM");
+}
+
+void printFlow() {
+  Serial.print("Flow: ");
+  Serial.print(flow.getFrequency() * 60.0f / FLOW_PULSES_PER_LITRE, 2);
+  Serial.println(" L/min");
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(TACH_PIN, INPUT_PULLUP);
+  pinMode(FLOW_PIN, INPUT_PULLUP);
+  tachGate.setCallback(printRPM);  // Runs after the gate is latched
+  flowGate.setCallback(printFlow);
+  tachGate.attachCounter(tach, TACH_PIN, FALLING);
+  flowGate.attachCounter(flow, FLOW_PIN, RISING);
+}
+
+void loop() {
+  tachGate.elapsed();
+  flowGate.elapsed();
+}
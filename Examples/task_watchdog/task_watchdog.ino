@@ -0,0 +1,51 @@
+#include "timewatchdog.h"
+#include "timescheduler.h"
+
+// Two tasks kick the watchdog each time they complete. The sensor task hangs for
+// good after 10 readings: the stall is reported, the hardware watchdog is no longer
+// fed, and the board resets (on AVR, ESP32 and RP2040).
+timescheduler<2> scheduler;
+timecontrol sensorTask(250);
+timecontrol blinkTask(500);
+timewatchdog<2> watchdog;
+
+uint8_t sensorId;
+uint8_t blinkId;
+
+void onStall(uint8_t id, uint32_t overdue) {
+  Serial.print("Task ");
+  Serial.print(id);
+  Serial.print(" stalled, ");
+  Serial.print(overdue);
+  Serial.println(" ms late");
+}
+
+void readSensor() {
+  if (sensorTask.elapsedCount() > 10) return;  // Simulated hang: stops kicking
+  watchdog.kick(sensorId);
+}
+
+void blink() {
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+  watchdog.kick(blinkId);
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(LED_BUILTIN, OUTPUT);
+  sensorTask.setCallback(readSensor);
+  blinkTask.setCallback(blink);
+  scheduler.add(sensorTask);
+  scheduler.add(blinkTask);
+
+  sensorId = watchdog.add(1000);  // Four missed readings
+  blinkId = watchdog.add(2000);
+  watchdog.setCallback(onStall);
+  if (!watchdog.enableHardware(4000)) Serial.println("No hardware watchdog: report only");
+}
+
+void loop() {
+  scheduler.tick();
+  watchdog.check();
+  scheduler.idle();
+}
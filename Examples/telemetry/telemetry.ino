@@ -0,0 +1,44 @@
+#include "timetelemetry.h"
+
+// Three timers run on a scheduler. Every 10 s a binary stats snapshot is started and
+// streamed to Serial two records per loop, so the periodic tasks are never held up.
+// Decode on the host with the record layout in timetelemetry.h.
+timescheduler<4> scheduler;
+timecontrol fastTask(10);
+timecontrol sensorTask(250);
+timecontrol blinkTask(500);
+timecontrol dumpTask(10000);
+timetelemetry telemetry(scheduler);
+
+void sample() {
+  analogRead(A0);
+}
+
+void blink() {
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+void startDump() {
+  if (telemetry.isDone()) telemetry.begin();  // Skipped if the previous dump is still going
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  sensorTask.setCallback(sample);
+  blinkTask.setCallback(blink);
+  dumpTask.setCallback(startDump);
+  scheduler.add(fastTask);
+  scheduler.add(sensorTask);
+  scheduler.add(blinkTask);
+  scheduler.add(dumpTask);
+}
+
+void loop() {
+  scheduler.tick();
+  if (!telemetry.isDone()) {
+    telemetry.writeTo(Serial, 2);
+  } else {
+    scheduler.idle();
+  }
+}
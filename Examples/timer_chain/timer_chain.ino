@@ -0,0 +1,46 @@
+#include "timescheduler.h"
+
+// Button -> debounce (30 ms) -> hold-off (500 ms) -> three 100 ms pulses.
+// Finishing a stage starts the next one; idle stages are not in the scheduler's heap.
+const uint8_t BUTTON_PIN = 2;
+const uint8_t PULSE_PIN = LED_BUILTIN;
+
+timescheduler<3> scheduler;
+
+timecontrol debounce(30, false, 0);   // Stages wait stopped until the chain reaches them
+timecontrol holdOff(500, false, 0);
+timecontrol pulse(100, false, 0);
+
+void checkButton() {
+  if (digitalRead(BUTTON_PIN) == LOW) Serial.println("Pressed: hold-off");
+  else debounce.setNext(nullptr);       // Bounce: end the chain here this time
+}
+
+void togglePulse() {
+  digitalWrite(PULSE_PIN, !digitalRead(PULSE_PIN));
+}
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  pinMode(PULSE_PIN, OUTPUT);
+
+  debounce.setRepeatCount(1);
+  holdOff.setRepeatCount(1);
+  pulse.setRepeatCount(6);              // Three on/off pulses
+  debounce.setCallback(checkButton);
+  pulse.setCallback(togglePulse);
+  debounce.then(holdOff).then(pulse);
+
+  scheduler.add(debounce);
+  scheduler.add(holdOff);
+  scheduler.add(pulse);
+}
+
+void loop() {
+  if (digitalRead(BUTTON_PIN) == LOW && !debounce.isRunning() && !holdOff.isRunning() && !pulse.isRunning()) {
+    debounce.setNext(&holdOff);
+    debounce.restart();                 // Starts the chain
+  }
+  scheduler.tick();
+}
@@ -41,7 +41,7 @@ void loop() {
     Serial.println("Slow Task: 2 seconds have passed");
   }
 
-  // Optional: Show status every 5 seconds
+  // Optional: Show status every 5 seconds (remainingTime() only reads the timers)
   static timecontrol statusTimer(5000);
   if (statusTimer.elapsed()) {
     Serial.println("--- Status ---");
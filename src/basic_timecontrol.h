@@ -0,0 +1,572 @@
+/**
+ * @file basic_timecontrol.h
+ * @brief Header file for the basic_timecontrol class template.
+ * This file declares a compile-time configurable timer whose optional features 
+ * (callbacks, history, statistics, microseconds, total elapsed time, repetitions) cost no RAM 
+ * and no cycles when they are disabled.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef BASIC_TIMECONTROL_H
+#define BASIC_TIMECONTROL_H
+
+#include "timearduino.h"
+#include "timedelegate.h"
+
+// feature flags for basic_timecontrol
+const uint8_t TIMECONTROL_FEATURE_CALLBACKS = 0x01; /**< setCallback() and setElapsedCallback(). */
+const uint8_t TIMECONTROL_FEATURE_MICROS = 0x02;    /**< elapsedMicros() and its microsecond reference. */
+const uint8_t TIMECONTROL_FEATURE_TOTAL = 0x04;     /**< getTotalElapsedTime() and isTimeUp(). */
+const uint8_t TIMECONTROL_FEATURE_REPEAT = 0x08;    /**< setRepeatCount(), runOnce() and getRemainingCount(). */
+const uint8_t TIMECONTROL_FEATURE_STATS = 0x10;     /**< getMin/Max/MeanElapsedTime(), getElapsedVariance() and getJitter(). */
+const uint8_t TIMECONTROL_FEATURE_ALL = 0x1F;       /**< All the optional features. */
+
+/**
+ * @brief Feature storage for callbacks. The disabled specialization is empty.
+ */
+template <bool Enabled>
+struct basic_timecontrol_callbacks {
+  void (*_callback)(void);            /**< Callback function for elapsed events. */
+  void (*_elapsedCallback)(uint32_t); /**< Callback with elapsed time parameter. */
+  bool _useElapsedFirst;              /**< Priority of elapsed callback execution. */
+  timedelegate _delegate;             /**< Context-carrying callback, run after the other two. */
+
+  basic_timecontrol_callbacks()
+    : _callback(nullptr), _elapsedCallback(nullptr), _useElapsedFirst(false) {}
+
+  inline void fireCallbacks(uint32_t elapsedTime) {
+    if (_useElapsedFirst) {
+      if (_elapsedCallback) _elapsedCallback(elapsedTime);
+      if (_callback) _callback();
+    } else {
+      if (_callback) _callback();
+      if (_elapsedCallback) _elapsedCallback(elapsedTime);
+    }
+    _delegate(elapsedTime);
+  }
+};
+
+template <>
+struct basic_timecontrol_callbacks<false> {
+  inline void fireCallbacks(uint32_t) {}
+};
+
+/**
+ * @brief Feature storage for the microsecond reference. The disabled specialization is empty.
+ */
+template <bool Enabled>
+struct basic_timecontrol_micros {
+  uint32_t _pMicros;  /**< Previous micros value for microsecond timing. */
+
+  basic_timecontrol_micros()
+    : _pMicros(micros()) {}
+
+  inline void markMicros() {
+    _pMicros = micros();
+  }
+};
+
+template <>
+struct basic_timecontrol_micros<false> {
+  inline void markMicros() {}
+};
+
+/**
+ * @brief Feature storage for the total elapsed time. The disabled specialization is empty.
+ */
+template <bool Enabled>
+struct basic_timecontrol_total {
+  uint32_t _startTime;  /**< Time of creation or full reset for total elapsed time. */
+
+  basic_timecontrol_total()
+    : _startTime(millis()) {}
+
+  inline void markStart(uint32_t now) {
+    _startTime = now;
+  }
+};
+
+template <>
+struct basic_timecontrol_total<false> {
+  inline void markStart(uint32_t) {}
+};
+
+/**
+ * @brief Feature storage for repetitions. The disabled specialization is empty and never stops.
+ */
+template <bool Enabled>
+struct basic_timecontrol_repeat {
+  uint32_t _repeatCount;  /**< Number of repetitions (0 for infinite). */
+
+  basic_timecontrol_repeat()
+    : _repeatCount(0) {}
+
+  inline bool finished(uint32_t count) const {
+    return _repeatCount > 0 && count >= _repeatCount;
+  }
+};
+
+template <>
+struct basic_timecontrol_repeat<false> {
+  inline bool finished(uint32_t) const {
+    return false;
+  }
+};
+
+/**
+ * @brief Feature storage for the running statistics. The disabled specialization is empty.
+ */
+template <bool Enabled>
+struct basic_timecontrol_stats {
+  uint32_t _minElapsed;  /**< Shortest elapsed time since reset. */
+  uint32_t _maxElapsed;  /**< Longest elapsed time since reset. */
+  float _meanElapsed;    /**< Running mean of elapsed times (Welford). */
+  float _m2Elapsed;      /**< Running sum of squared deviations (Welford). */
+
+  basic_timecontrol_stats()
+    : _minElapsed(0xFFFFFFFF), _maxElapsed(0), _meanElapsed(0), _m2Elapsed(0) {}
+
+  inline void recordStats(uint32_t elapsedTime, uint32_t count) {
+    if (elapsedTime < _minElapsed) _minElapsed = elapsedTime;
+    if (elapsedTime > _maxElapsed) _maxElapsed = elapsedTime;
+    float delta = (float)elapsedTime - _meanElapsed;  // Welford, n = count + 1
+    _meanElapsed += delta / (float)(count + 1);
+    _m2Elapsed += delta * ((float)elapsedTime - _meanElapsed);
+  }
+
+  inline void clearStats() {
+    _minElapsed = 0xFFFFFFFF;
+    _maxElapsed = 0;
+    _meanElapsed = 0;
+    _m2Elapsed = 0;
+  }
+};
+
+template <>
+struct basic_timecontrol_stats<false> {
+  inline void recordStats(uint32_t, uint32_t) {}
+  inline void clearStats() {}
+};
+
+/**
+ * @brief Feature storage for the elapsed history. A depth of 0 is empty.
+ * @tparam Depth Number of elapsed times kept for getAverageElapsedTime() (power of two, up to 128).
+ */
+template <uint8_t Depth>
+struct basic_timecontrol_history {
+  static_assert((Depth & (Depth - 1)) == 0 && Depth <= 128, "HistoryDepth must be a power of two up to 128");
+  static const uint8_t mask = Depth - 1;  /**< Index mask for the history ring. */
+
+  uint32_t _lastElapsedTime;       /**< Duration of the last elapsed event in milliseconds. */
+  uint32_t _elapsedTimes[Depth];   /**< Buffer for storing last elapsed times. */
+  uint32_t _historySum;            /**< Running sum of the elapsed times buffer. */
+  uint8_t _elapsedIndex;           /**< Index for elapsed times buffer. */
+
+  basic_timecontrol_history()
+    : _lastElapsedTime(0), _elapsedTimes(), _historySum(0), _elapsedIndex(0) {}
+
+  inline void record(uint32_t elapsedTime) {
+    _lastElapsedTime = elapsedTime;
+    _historySum += elapsedTime - _elapsedTimes[_elapsedIndex];
+    _elapsedTimes[_elapsedIndex] = elapsedTime;
+    _elapsedIndex = (_elapsedIndex + 1) & mask;
+  }
+
+  inline void clearHistory() {
+    _lastElapsedTime = 0;
+    memset(_elapsedTimes, 0, sizeof(_elapsedTimes));
+    _historySum = 0;
+    _elapsedIndex = 0;
+  }
+};
+
+template <>
+struct basic_timecontrol_history<0> {
+  inline void record(uint32_t) {}
+  inline void clearHistory() {}
+};
+
+/**
+ * @brief Compile-time configurable timer.
+ * 
+ * Behaves like timecontrol for the features it is built with. Each optional feature lives 
+ * in its own storage base, whose disabled specialization is empty, so a disabled 
+ * feature adds no bytes (empty base optimization) and its hooks in elapsed() compile to 
+ * nothing. Calling a method of a disabled feature is a compile-time error.
+ * 
+ * With no optional feature the timer holds only its timelapse, reference, count and 
+ * state (13 bytes on AVR). It is polled directly and does not register with timescheduler.
+ * 
+ * @tparam Features Bitwise OR of TIMECONTROL_FEATURE_* flags.
+ * @tparam HistoryDepth Number of elapsed times kept (power of two, 0 to disable the history).
+ */
+template <uint8_t Features = TIMECONTROL_FEATURE_ALL, uint8_t HistoryDepth = 16>
+class basic_timecontrol
+  : public basic_timecontrol_callbacks<(Features & TIMECONTROL_FEATURE_CALLBACKS) != 0>,
+    public basic_timecontrol_micros<(Features & TIMECONTROL_FEATURE_MICROS) != 0>,
+    public basic_timecontrol_total<(Features & TIMECONTROL_FEATURE_TOTAL) != 0>,
+    public basic_timecontrol_repeat<(Features & TIMECONTROL_FEATURE_REPEAT) != 0>,
+    public basic_timecontrol_stats<(Features & TIMECONTROL_FEATURE_STATS) != 0>,
+    public basic_timecontrol_history<HistoryDepth> {
+public:
+  static const bool hasCallbacks = (Features & TIMECONTROL_FEATURE_CALLBACKS) != 0; /**< Callbacks are compiled in. */
+  static const bool hasMicros = (Features & TIMECONTROL_FEATURE_MICROS) != 0;       /**< elapsedMicros() is compiled in. */
+  static const bool hasTotal = (Features & TIMECONTROL_FEATURE_TOTAL) != 0;         /**< Total elapsed time is compiled in. */
+  static const bool hasRepeat = (Features & TIMECONTROL_FEATURE_REPEAT) != 0;       /**< Repetitions are compiled in. */
+  static const bool hasStats = (Features & TIMECONTROL_FEATURE_STATS) != 0;         /**< Running statistics are compiled in. */
+  static const bool hasHistory = HistoryDepth > 0;                                  /**< Elapsed history is compiled in. */
+
+  basic_timecontrol()
+    : _timelapse(0), pMillis(millis()), _count(0), _state(true) {}          /**< Default constructor. */
+  basic_timecontrol(uint32_t timelapse)
+    : _timelapse(timelapse), pMillis(millis()), _count(0), _state(true) {}  /**< Constructor with timelapse parameter. */
+
+  /**
+   * @brief Get the timelapse value.
+   * @return The timelapse value in milliseconds.
+   */
+  inline uint32_t getTimelapse() const {
+    return _timelapse;
+  }
+
+  /**
+   * @brief Set the timelapse interval for the timer.
+   * @param timelapse The new timelapse value in milliseconds (or microseconds for elapsedMicros).
+   */
+  inline void setTimelapse(uint32_t timelapse) {
+    _timelapse = timelapse;
+  }
+
+  /**
+   * @brief Set the state of the timer.
+   * @param state The state to set (true for active, false for inactive).
+   */
+  inline void setState(bool state) {
+    _state = state;
+  }
+
+  /**
+   * @brief Get the state of the timer.
+   * @return The state of the timer (true for active, false for inactive).
+   */
+  inline bool getState() const {
+    return _state;
+  }
+
+  /**
+   * @brief Check if the timer is currently running.
+   * @return True if the timer is running, false if paused.
+   */
+  inline bool isRunning() const {
+    return _state;
+  }
+
+  /**
+   * @brief Stop the timer.
+   */
+  inline void stop() {
+    _state = false;
+  }
+
+  /**
+   * @brief Resume the timer.
+   */
+  inline void resume() {
+    _state = true;
+  }
+
+  /**
+   * @brief Reset the reference times and the event counter without altering the state or timelapse.
+   */
+  inline void reset() {
+    pMillis = millis();
+    this->markMicros();
+    _count = 0;
+    this->clearHistory();
+    this->clearStats();
+  }
+
+  /**
+   * @brief Restart the timer by resetting and ensuring it is running.
+   */
+  inline void restart() {
+    reset();
+    resume();
+  }
+
+  /**
+   * @brief Check if the timelapse has elapsed.
+   * @return True if the timelapse has elapsed, false otherwise.
+   */
+  inline bool elapsed() {
+    return elapsed(millis());
+  }
+
+  /**
+   * @brief Check if the timelapse has elapsed against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return True if the timelapse has elapsed, false otherwise.
+   */
+  bool elapsed(uint32_t now) {
+    if (!_state) return false;
+    uint32_t elapsedTime = now - pMillis;
+    if (elapsedTime < _timelapse) return false;
+    pMillis = now;
+    this->markMicros();
+    fire(elapsedTime);
+    return true;
+  }
+
+  /**
+   * @brief Check if the timelapse has elapsed, using microseconds instead of milliseconds.
+   * Requires TIMECONTROL_FEATURE_MICROS.
+   * @return True if the timelapse (in microseconds) has elapsed, false otherwise.
+   */
+  bool elapsedMicros() {
+    static_assert(hasMicros, "elapsedMicros() requires TIMECONTROL_FEATURE_MICROS");
+    if (!_state) return false;
+    uint32_t current = micros();
+    uint32_t elapsedTime = current - this->_pMicros;
+    if (elapsedTime < _timelapse) return false;
+    this->_pMicros = current;
+    pMillis = millis();
+    fire(elapsedTime / 1000);
+    return true;
+  }
+
+  /**
+   * @brief Get the elapsed time since the last reset or event, in milliseconds.
+   * @return The elapsed time in milliseconds if running, 0 otherwise.
+   */
+  inline uint32_t getElapsedTime() const {
+    return _state ? (millis() - pMillis) : 0;
+  }
+
+  /**
+   * @brief Get the remaining time until the next elapsed event, in milliseconds (read-only).
+   * @return The remaining time in milliseconds, or 0 if stopped or elapsed.
+   */
+  inline uint32_t remainingTime() const {
+    uint32_t elapsedTime = millis() - pMillis;
+    return (_state && elapsedTime < _timelapse) ? (_timelapse - elapsedTime) : 0;
+  }
+
+  /**
+   * @brief Get the number of elapsed events since last reset.
+   * @return The count of elapsed events.
+   */
+  inline uint32_t elapsedCount() const {
+    return _count;
+  }
+
+  /**
+   * @brief Set a permanent callback function. Requires TIMECONTROL_FEATURE_CALLBACKS.
+   * @param callback The function to execute.
+   */
+  inline void setCallback(void (*callback)(void)) {
+    static_assert(hasCallbacks, "setCallback() requires TIMECONTROL_FEATURE_CALLBACKS");
+    this->_callback = callback;
+  }
+
+  /**
+   * @brief Set a context-carrying callback. Requires TIMECONTROL_FEATURE_CALLBACKS.
+   * @param callback The delegate to execute after the other callbacks.
+   */
+  inline void setCallback(timedelegate callback) {
+    static_assert(hasCallbacks, "setCallback() requires TIMECONTROL_FEATURE_CALLBACKS");
+    this->_delegate = callback;
+  }
+
+  /**
+   * @brief Set a callback with a user context. Requires TIMECONTROL_FEATURE_CALLBACKS.
+   * @param callback The function (or captureless lambda) to execute.
+   * @param context The pointer passed back to the callback.
+   */
+  inline void setCallback(timedelegate::function callback, void* context) {
+    static_assert(hasCallbacks, "setCallback() requires TIMECONTROL_FEATURE_CALLBACKS");
+    this->_delegate = timedelegate(callback, context);
+  }
+
+  /**
+   * @brief Set a callback that receives the elapsed time. Requires TIMECONTROL_FEATURE_CALLBACKS.
+   * @param callback The function to execute with elapsed time.
+   */
+  inline void setElapsedCallback(void (*callback)(uint32_t)) {
+    static_assert(hasCallbacks, "setElapsedCallback() requires TIMECONTROL_FEATURE_CALLBACKS");
+    this->_elapsedCallback = callback;
+  }
+
+  /**
+   * @brief Set the priority of callback execution. Requires TIMECONTROL_FEATURE_CALLBACKS.
+   * @param useElapsedFirst True to execute elapsedCallback first, false for simple callback first.
+   */
+  inline void setPriorityCallback(bool useElapsedFirst) {
+    static_assert(hasCallbacks, "setPriorityCallback() requires TIMECONTROL_FEATURE_CALLBACKS");
+    this->_useElapsedFirst = useElapsedFirst;
+  }
+
+  /**
+   * @brief Set the number of repetitions before stopping. Requires TIMECONTROL_FEATURE_REPEAT.
+   * @param count Number of repetitions (0 for infinite).
+   */
+  inline void setRepeatCount(uint32_t count) {
+    static_assert(hasRepeat, "setRepeatCount() requires TIMECONTROL_FEATURE_REPEAT");
+    this->_repeatCount = count;
+  }
+
+  /**
+   * @brief Get the configured repeat count. Requires TIMECONTROL_FEATURE_REPEAT.
+   * @return The number of repetitions set (0 for infinite).
+   */
+  inline uint32_t getRepeatCount() const {
+    static_assert(hasRepeat, "getRepeatCount() requires TIMECONTROL_FEATURE_REPEAT");
+    return this->_repeatCount;
+  }
+
+  /**
+   * @brief Configure the timer to run once. Requires TIMECONTROL_FEATURE_REPEAT.
+   */
+  inline void runOnce() {
+    setRepeatCount(1);
+    resume();
+  }
+
+  /**
+   * @brief Get the remaining number of repetitions. Requires TIMECONTROL_FEATURE_REPEAT.
+   * @return Remaining repetitions, or 0 if infinite.
+   */
+  inline uint32_t getRemainingCount() const {
+    static_assert(hasRepeat, "getRemainingCount() requires TIMECONTROL_FEATURE_REPEAT");
+    return (this->_repeatCount > 0 && _count < this->_repeatCount) ? (this->_repeatCount - _count) : 0;
+  }
+
+  /**
+   * @brief Get the total elapsed time since creation or fullReset(). Requires TIMECONTROL_FEATURE_TOTAL.
+   * @return Total elapsed time in milliseconds.
+   */
+  inline uint32_t getTotalElapsedTime() const {
+    static_assert(hasTotal, "getTotalElapsedTime() requires TIMECONTROL_FEATURE_TOTAL");
+    return millis() - this->_startTime;
+  }
+
+  /**
+   * @brief Check if total elapsed time exceeds a timeout. Requires TIMECONTROL_FEATURE_TOTAL.
+   * @param timeout Timeout in milliseconds.
+   * @return True if time is up, false otherwise.
+   */
+  inline bool isTimeUp(uint32_t timeout) const {
+    return getTotalElapsedTime() >= timeout;
+  }
+
+  /**
+   * @brief Fully reset the timer, including the start time when it is compiled in.
+   */
+  inline void fullReset() {
+    pMillis = millis();
+    this->markStart(pMillis);
+    this->markMicros();
+    _count = 0;
+    this->clearHistory();
+    this->clearStats();
+    _state = true;
+  }
+
+  /**
+   * @brief Get the duration of the last elapsed event. Requires a history depth above 0.
+   * @return The duration of the last elapsed event in milliseconds, or 0 if none occurred yet.
+   */
+  inline uint32_t getLastElapsedTime() const {
+    static_assert(hasHistory, "getLastElapsedTime() requires a HistoryDepth above 0");
+    return this->_lastElapsedTime;
+  }
+
+  /**
+   * @brief Get the average elapsed time over a number of samples. Requires a history depth above 0.
+   * 
+   * Averaging the whole history uses the running window sum and costs O(1).
+   * 
+   * @param samples Number of samples to average (max HistoryDepth).
+   * @return Average elapsed time in milliseconds.
+   */
+  uint32_t getAverageElapsedTime(uint8_t samples) const {
+    static_assert(hasHistory, "getAverageElapsedTime() requires a HistoryDepth above 0");
+    if (_count == 0) return 0;
+    uint8_t validSamples = (_count < HistoryDepth) ? (uint8_t)_count : HistoryDepth;
+    if (samples >= validSamples) return this->_historySum / validSamples;
+    if (samples == 0) return 0;
+    uint32_t sum = 0;
+    for (uint8_t i = 1; i <= samples; i++) {
+      sum += this->_elapsedTimes[(uint8_t)(this->_elapsedIndex - i) & this->mask];
+    }
+    return sum / samples;
+  }
+
+  /**
+   * @brief Get the shortest elapsed event duration since the last reset. Requires TIMECONTROL_FEATURE_STATS.
+   * @return The minimum duration in milliseconds, or 0 if no event has occurred yet.
+   */
+  inline uint32_t getMinElapsedTime() const {
+    static_assert(hasStats, "getMinElapsedTime() requires TIMECONTROL_FEATURE_STATS");
+    return (_count > 0) ? this->_minElapsed : 0;
+  }
+
+  /**
+   * @brief Get the longest elapsed event duration since the last reset. Requires TIMECONTROL_FEATURE_STATS.
+   * @return The maximum duration in milliseconds.
+   */
+  inline uint32_t getMaxElapsedTime() const {
+    static_assert(hasStats, "getMaxElapsedTime() requires TIMECONTROL_FEATURE_STATS");
+    return this->_maxElapsed;
+  }
+
+  /**
+   * @brief Get the mean elapsed event duration since the last reset. Requires TIMECONTROL_FEATURE_STATS.
+   * @return The running mean in milliseconds.
+   */
+  inline float getMeanElapsedTime() const {
+    static_assert(hasStats, "getMeanElapsedTime() requires TIMECONTROL_FEATURE_STATS");
+    return this->_meanElapsed;
+  }
+
+  /**
+   * @brief Get the variance of the elapsed event durations since the last reset. Requires TIMECONTROL_FEATURE_STATS.
+   * @return The population variance in ms², or 0 with fewer than two events.
+   */
+  inline float getElapsedVariance() const {
+    static_assert(hasStats, "getElapsedVariance() requires TIMECONTROL_FEATURE_STATS");
+    return (_count > 1) ? this->_m2Elapsed / (float)_count : 0;
+  }
+
+  /**
+   * @brief Get the peak-to-peak jitter of the elapsed event durations since the last reset. Requires TIMECONTROL_FEATURE_STATS.
+   * @return The difference between the longest and shortest durations in milliseconds.
+   */
+  inline uint32_t getJitter() const {
+    static_assert(hasStats, "getJitter() requires TIMECONTROL_FEATURE_STATS");
+    return (_count > 0) ? this->_maxElapsed - this->_minElapsed : 0;
+  }
+
+private:
+  uint32_t _timelapse;  /**< The timelapse value in milliseconds. */
+  uint32_t pMillis;     /**< Previous millis value for time control. */
+  uint32_t _count;      /**< Counter for elapsed events. */
+  bool _state;          /**< The state of the timer (true for active, false for inactive). */
+
+  inline void fire(uint32_t elapsedTime) {
+    this->record(elapsedTime);
+    this->recordStats(elapsedTime, _count);
+    _count++;
+    this->fireCallbacks(elapsedTime);
+    if (this->finished(_count)) _state = false;
+  }
+};
+
+/**
+ * @brief Smallest configuration: no optional feature, no history.
+ */
+typedef basic_timecontrol<0, 0> timecontrol_lite;
+
+#endif  // BASIC_TIMECONTROL_H
@@ -0,0 +1,20 @@
+/**
+ * @file timearduino.h
+ * @brief Selects the Arduino core, or its desktop stand-in with a virtual clock.
+ * Every library header includes this file instead of <Arduino.h>.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEARDUINO_H
+#define TIMEARDUINO_H
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include "timehost.h"
+#endif
+
+#endif  // TIMEARDUINO_H
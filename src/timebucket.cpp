@@ -0,0 +1,68 @@
+/**
+ * @file timebucket.cpp
+ * @brief Lazy token-bucket refill and wait-time computation.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timebucket.h"
+
+timebucket::timebucket(uint32_t capacity, uint32_t period, uint32_t refill)
+  : _capacity(capacity), _tokens(capacity), _period(period ? period : 1), _refill(refill), _last(millis()) {
+}
+
+bool timebucket::tryAcquire(uint32_t tokens, uint32_t now) {
+  refill(now);
+  if (tokens > _tokens) return false;
+  _tokens -= tokens;
+  return true;
+}
+
+uint32_t timebucket::timeUntilAvailable(uint32_t tokens, uint32_t now) {
+  refill(now);
+  if (tokens <= _tokens) return 0;
+  if (tokens > _capacity || _refill == 0) return TIMEBUCKET_NEVER;
+  uint32_t periods = (tokens - _tokens + _refill - 1) / _refill;  // Whole periods still to earn
+  return periods * _period - (now - _last);
+}
+
+bool timebucket::wakeWhenAvailable(timecontrol& timer, uint32_t tokens) {
+  uint32_t wait = timeUntilAvailable(tokens);
+  if (wait == TIMEBUCKET_NEVER) return false;
+  timer.setTimelapse(wait);
+  timer.setRepeatCount(1);
+  timer.restart();
+  return true;
+}
+
+void timebucket::fill() {
+  _tokens = _capacity;
+  _last = millis();
+}
+
+void timebucket::drain() {
+  _tokens = 0;
+  _last = millis();
+}
+
+void timebucket::setRate(uint32_t period, uint32_t refill) {
+  this->refill(millis());  // Settle the tokens earned at the old rate
+  _period = period ? period : 1;
+  _refill = refill;
+}
+
+void timebucket::refill(uint32_t now) {
+  uint32_t elapsed = now - _last;
+  if (elapsed < _period) return;  // No division until a whole period has passed
+  uint32_t periods = elapsed / _period;
+  uint32_t room = _capacity - _tokens;
+  if (_refill > 0 && periods <= room / _refill && periods * _refill < room) {
+    _tokens += periods * _refill;
+    _last += periods * _period;   // Keep the partial period
+  } else {
+    if (_refill > 0) _tokens = _capacity;
+    _last = now;                  // Full: the partial period is dropped with the excess tokens
+  }
+}
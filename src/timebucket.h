@@ -0,0 +1,141 @@
+/**
+ * @file timebucket.h
+ * @brief Header file for the timebucket class.
+ * This file declares a token-bucket rate limiter on the millis() timebase, refilled lazily 
+ * from the elapsed time, for throttling radio, MQTT and serial output.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEBUCKET_H
+#define TIMEBUCKET_H
+
+#include "timecontrol.h"
+
+const uint32_t TIMEBUCKET_NEVER = 0xFFFFFFFF; /**< Returned by timeUntilAvailable() for more tokens than the capacity. */
+
+/**
+ * @brief Token bucket: bursts up to a capacity, a sustained rate of tokens per period.
+ * 
+ * Nothing ticks in the background. The tokens earned since the last call are added when 
+ * the bucket is used, from the time elapsed, so every method is O(1) and a bucket costs 
+ * 20 bytes. Partial periods are carried over, so the long-run rate is exact. 
+ * timeUntilAvailable() tells how long to wait for n tokens: feed it to a sleeping scheduler 
+ * (see wakeWhenAvailable()) to wake exactly when the next send is allowed.
+ * 
+ * Times use wrap-safe 32-bit arithmetic; the bucket must be used at least once per 49.7 
+ * days (an idle bucket is simply full).
+ */
+class timebucket {
+public:
+  /**
+   * @brief Construct a full bucket.
+   * @param capacity Maximum number of tokens (burst size).
+   * @param period Milliseconds to earn refill tokens.
+   * @param refill Tokens earned per period.
+   */
+  timebucket(uint32_t capacity, uint32_t period, uint32_t refill = 1);
+
+  /**
+   * @brief Take tokens if enough are available.
+   * @param tokens The number of tokens to take.
+   * @return True if they were taken, false (bucket unchanged) if not enough are available.
+   */
+  inline bool tryAcquire(uint32_t tokens = 1) {
+    return tryAcquire(tokens, millis());
+  }
+
+  /**
+   * @brief Take tokens if enough are available, against a timestamp captured by the caller.
+   * @param tokens The number of tokens to take.
+   * @param now The current time in milliseconds.
+   * @return True if they were taken.
+   */
+  bool tryAcquire(uint32_t tokens, uint32_t now);
+
+  /**
+   * @brief Get the number of tokens available now.
+   * @return The tokens in the bucket.
+   */
+  inline uint32_t available() {
+    return available(millis());
+  }
+
+  /**
+   * @brief Get the number of tokens available against a captured timestamp.
+   * @param now The current time in milliseconds.
+   * @return The tokens in the bucket.
+   */
+  inline uint32_t available(uint32_t now) {
+    refill(now);
+    return _tokens;
+  }
+
+  /**
+   * @brief Get the time to wait before tryAcquire(tokens) can succeed.
+   * @param tokens The number of tokens wanted.
+   * @return The time in milliseconds, 0 if they are available now, or TIMEBUCKET_NEVER 
+   * if tokens exceeds the capacity.
+   */
+  inline uint32_t timeUntilAvailable(uint32_t tokens = 1) {
+    return timeUntilAvailable(tokens, millis());
+  }
+
+  /**
+   * @brief Get the time to wait for tokens against a captured timestamp.
+   * @param tokens The number of tokens wanted.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds, 0 if available, or TIMEBUCKET_NEVER.
+   */
+  uint32_t timeUntilAvailable(uint32_t tokens, uint32_t now);
+
+  /**
+   * @brief Arm a one-shot timer to elapse when tokens become available.
+   * 
+   * Registered with a timescheduler, the timer makes idle() wake up exactly when the next 
+   * send is allowed; its callback can then call tryAcquire().
+   * 
+   * @param timer The timer to arm (its timelapse and repeat count are overwritten).
+   * @param tokens The number of tokens wanted.
+   * @return False if tokens exceeds the capacity (timer unchanged).
+   */
+  bool wakeWhenAvailable(timecontrol& timer, uint32_t tokens = 1);
+
+  /**
+   * @brief Fill the bucket to its capacity.
+   */
+  void fill();
+
+  /**
+   * @brief Remove all tokens, as if a full burst had just been sent.
+   */
+  void drain();
+
+  /**
+   * @brief Change the rate. Tokens already earned are kept.
+   * @param period Milliseconds to earn refill tokens.
+   * @param refill Tokens earned per period.
+   */
+  void setRate(uint32_t period, uint32_t refill = 1);
+
+  /**
+   * @brief Get the maximum number of tokens.
+   * @return The capacity.
+   */
+  inline uint32_t getCapacity() const {
+    return _capacity;
+  }
+
+private:
+  uint32_t _capacity;  /**< Maximum tokens. */
+  uint32_t _tokens;    /**< Tokens available at _last. */
+  uint32_t _period;    /**< Milliseconds to earn _refill tokens. */
+  uint32_t _refill;    /**< Tokens per period. */
+  uint32_t _last;      /**< Start of the period being earned. */
+
+  void refill(uint32_t now);
+};
+
+#endif  // TIMEBUCKET_H
@@ -0,0 +1,82 @@
+/**
+ * @file timecalendar.cpp
+ * @brief Implementation of the timecalendar class: wall clock sync, rule occurrences and 
+ * the one-shot timers that wait for them.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timecalendar.h"
+
+timecalendarbase::timecalendarbase(entry* entries, uint8_t capacity)
+  : _entries(entries), _capacity(capacity), _size(0), _synced(false), _utcOffset(0), _epoch(0),
+    _callback(nullptr) {}
+
+void timecalendarbase::sync(uint32_t unixTime, uint16_t millisecond) {
+  _epoch = (uint64_t)unixTime * 1000 + millisecond - timeclock::millis64();
+  _synced = true;
+  rearmAll();
+}
+
+void timecalendarbase::setUtcOffset(int32_t seconds) {
+  _utcOffset = seconds;
+  if (_synced) rearmAll();
+}
+
+uint8_t timecalendarbase::every(timecontrol& timer, uint32_t period, uint32_t offset) {
+  if (_size >= _capacity || period == 0) return TIMECALENDAR_NONE;
+  entry& rule = _entries[_size];
+  rule.owner = this;
+  rule.timer = &timer;
+  rule.period = period;
+  rule.offset = offset % period;
+  rule.next = 0;
+  timer.setCallback(&onTimer, &rule);
+  if (_synced) {
+    schedule(rule);
+  } else {
+    timer.stop();  // Waits for sync()
+  }
+  return _size++;
+}
+
+void timecalendarbase::rearmAll() {
+  for (uint8_t id = 0; id < _size; id++) schedule(_entries[id]);
+}
+
+void timecalendarbase::schedule(entry& rule) {
+  uint64_t local = localMillis();
+  uint32_t current = (uint32_t)(local / 1000);
+  uint32_t phase = (current % rule.period + rule.period - rule.offset) % rule.period;
+  rule.next = current - phase + rule.period;  // First occurrence after the current second
+  arm(rule, local);
+}
+
+void timecalendarbase::arm(entry& rule, uint64_t local) {
+  uint64_t target = (uint64_t)rule.next * 1000;
+  uint64_t wait = (target > local) ? target - local : 0;
+  rule.timer->setTimelapse((wait > TIMECALENDAR_MAX_ARM) ? TIMECALENDAR_MAX_ARM : (uint32_t)wait);
+  rule.timer->setRepeatCount(1);
+  rule.timer->restart();
+}
+
+void timecalendarbase::onTimer(void* context, uint32_t) {
+  entry& rule = *static_cast<entry*>(context);
+  timecalendarbase& calendar = *rule.owner;
+  uint64_t local = calendar.localMillis();
+  if (local < (uint64_t)rule.next * 1000) {  // One step of a long wait, or a clock corrected backward
+    calendar.arm(rule, local);
+    return;
+  }
+
+  uint32_t time = rule.next;
+  rule.next += rule.period;  // The incremental step: no date math
+  if (local >= (uint64_t)rule.next * 1000) {
+    calendar.schedule(rule);  // Late by more than a period (blocked loop): skip to the future
+  } else {
+    calendar.arm(rule, local);
+  }
+  if (calendar._callback) calendar._callback(&rule - calendar._entries, time);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file timecalendar.h
+ * @brief Header file for the timecalendar class.
+ * This file declares a wall-clock layer, synced from an RTC, NTP or GPS, that maps 
+ * calendar rules ("every day at 02:00", "every 15 minutes aligned to the hour") onto 
+ * one-shot timers in the scheduler.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMECALENDAR_H
+#define TIMECALENDAR_H
+
+#include "timecontrol.h"
+#include "timeclock.h"
+
+const uint8_t TIMECALENDAR_NONE = 0xFF;                   /**< Returned by the rule methods when the calendar is full or the rule is invalid. */
+const uint32_t SECONDS_PER_WEEK = 7 * SECONDS_PER_DAY;    /**< The number of seconds in a week. */
+
+#ifndef TIMECALENDAR_MAX_ARM
+#define TIMECALENDAR_MAX_ARM 86400000UL  /**< Longest single wait of a rule timer (ms); longer waits are re-armed in steps. */
+#endif
+
+/**
+ * @brief Capacity-independent part of the wall-clock calendar.
+ * 
+ * The wall clock is a single 64-bit offset between the Unix epoch and timeclock::millis64(), 
+ * set by sync(), so reading it costs no date math. Each rule is a period and an offset in 
+ * local time: every(900) fires at :00, :15, :30 and :45, daily(2, 0) is every(86400, 7200). 
+ * A rule drives a timecontrol registered with the scheduler, armed as a one-shot for the 
+ * exact time left before the next occurrence. The next occurrence is only recomputed when 
+ * the rule fires (one addition) and when the clock is corrected by sync() or 
+ * setUtcOffset(), never while waiting: idle() sleeps until the rule is due.
+ * 
+ * Waits longer than TIMECALENDAR_MAX_ARM are split into steps, so deadlines stay inside the 
+ * scheduler's wrap-safe range. Occurrences missed by a clock jump forward are skipped, and 
+ * a jump backward can repeat them.
+ * 
+ * Use timecalendar<N> to get a calendar with its own storage.
+ */
+class timecalendarbase {
+public:
+  typedef void (*rulecallback)(uint8_t id, uint32_t time);  /**< Rule callback: rule id and the local time of the occurrence, in seconds. */
+
+  /**
+   * @brief Set the wall clock and re-arm every rule.
+   * @param unixTime The current UTC time in seconds since 1970-01-01.
+   * @param millisecond The fraction of the current second, for NTP or a GPS PPS edge.
+   */
+  void sync(uint32_t unixTime, uint16_t millisecond = 0);
+
+  /**
+   * @brief Check whether sync() has been called. Rules wait (timers stopped) until it is.
+   * @return True once the wall clock is set.
+   */
+  inline bool isSynced() const {
+    return _synced;
+  }
+
+  /**
+   * @brief Set the local time offset used by the rules, and re-arm them.
+   * @param seconds The offset from UTC in seconds (3600 for UTC+1).
+   */
+  void setUtcOffset(int32_t seconds);
+
+  /**
+   * @brief Get the local time offset.
+   * @return The offset from UTC in seconds.
+   */
+  inline int32_t getUtcOffset() const {
+    return _utcOffset;
+  }
+
+  /**
+   * @brief Get the current UTC time.
+   * @return The seconds since 1970-01-01, or 0 before sync().
+   */
+  inline uint32_t now() const {
+    return _synced ? (uint32_t)(utcMillis() / 1000) : 0;
+  }
+
+  /**
+   * @brief Get the current local time: UTC plus the offset.
+   * @return The local seconds since 1970-01-01, or 0 before sync().
+   */
+  inline uint32_t localTime() const {
+    return _synced ? (uint32_t)(localMillis() / 1000) : 0;
+  }
+
+  /**
+   * @brief Fire at every multiple of a period, shifted by an offset, in local time.
+   * 
+   * every(900) is every 15 minutes aligned to the hour, every(SECONDS_PER_DAY, 7200) every 
+   * day at 02:00. The timer must be registered with a timescheduler; its timelapse, repeat 
+   * count and context callback are taken over by the rule.
+   * 
+   * @param timer The timer driving the rule.
+   * @param period The period in seconds (not 0).
+   * @param offset The offset into the period in seconds.
+   * @return The rule id, or TIMECALENDAR_NONE if the calendar is full or period is 0.
+   */
+  uint8_t every(timecontrol& timer, uint32_t period, uint32_t offset = 0);
+
+  /**
+   * @brief Fire every day at a local time.
+   * @param timer The timer driving the rule.
+   * @param hour The hour, 0 to 23.
+   * @param minute The minute, 0 to 59.
+   * @return The rule id, or TIMECALENDAR_NONE.
+   */
+  inline uint8_t daily(timecontrol& timer, uint8_t hour, uint8_t minute = 0) {
+    return every(timer, SECONDS_PER_DAY, (uint32_t)hour * SECONDS_PER_HOUR + (uint32_t)minute * SECONDS_PER_MINUTE);
+  }
+
+  /**
+   * @brief Fire every week on a day at a local time.
+   * @param timer The timer driving the rule.
+   * @param weekday The day, 0 (Sunday) to 6 (Saturday).
+   * @param hour The hour, 0 to 23.
+   * @param minute The minute, 0 to 59.
+   * @return The rule id, or TIMECALENDAR_NONE.
+   */
+  inline uint8_t weekly(timecontrol& timer, uint8_t weekday, uint8_t hour, uint8_t minute = 0) {
+    uint32_t day = (weekday + 3) % 7;  // 1970-01-01 was a Thursday: day 0 of the week count
+    return every(timer, SECONDS_PER_WEEK, day * SECONDS_PER_DAY + (uint32_t)hour * SECONDS_PER_HOUR + (uint32_t)minute * SECONDS_PER_MINUTE);
+  }
+
+  /**
+   * @brief Set the function run at each occurrence of a rule.
+   * @param callback Function receiving the rule id and the local time of the occurrence.
+   */
+  inline void setCallback(rulecallback callback) {
+    _callback = callback;
+  }
+
+  /**
+   * @brief Get the next occurrence of a rule.
+   * @param id The rule id.
+   * @return The local time of the occurrence in seconds, or 0 before sync() or for an unknown id.
+   */
+  inline uint32_t nextOccurrence(uint8_t id) const {
+    return (_synced && id < _size) ? _entries[id].next : 0;
+  }
+
+  /**
+   * @brief Get the number of rules added.
+   * @return The number of ids in use.
+   */
+  inline uint8_t size() const {
+    return _size;
+  }
+
+  /**
+   * @brief Get the maximum number of rules.
+   * @return The calendar capacity.
+   */
+  inline uint8_t capacity() const {
+    return _capacity;
+  }
+
+protected:
+  /**
+   * @brief State of one rule.
+   */
+  struct entry {
+    timecalendarbase* owner;  /**< Calendar the rule belongs to (timer callback context). */
+    timecontrol* timer;       /**< Timer armed for the next occurrence. */
+    uint32_t period;          /**< Period in seconds. */
+    uint32_t offset;          /**< Offset into the period, below period. */
+    uint32_t next;            /**< Next occurrence, local seconds. */
+  };
+
+  timecalendarbase(entry* entries, uint8_t capacity);  /**< Constructor with storage provided by the derived class. */
+
+private:
+  entry* _entries;          /**< Rule entries, indexed by id. */
+  uint8_t _capacity;        /**< Number of available entries. */
+  uint8_t _size;            /**< Number of ids handed out. */
+  bool _synced;             /**< True once sync() has been called. */
+  int32_t _utcOffset;       /**< Local time offset in seconds. */
+  uint64_t _epoch;          /**< UTC milliseconds since 1970 when millis64() was 0. */
+  rulecallback _callback;   /**< Rule callback, or nullptr. */
+
+  inline uint64_t utcMillis() const {
+    return _epoch + timeclock::millis64();
+  }
+
+  inline uint64_t localMillis() const {
+    return utcMillis() + (int64_t)_utcOffset * 1000;
+  }
+
+  void schedule(entry& rule);
+  void arm(entry& rule, uint64_t local);
+  void rearmAll();
+  static void onTimer(void* context, uint32_t elapsedTime);
+};
+
+/**
+ * @brief Wall-clock calendar with storage for a fixed number of rules (no dynamic memory).
+ * @tparam Capacity Maximum number of rules (up to 254).
+ */
+template <uint8_t Capacity>
+class timecalendar : public timecalendarbase {
+  static_assert(Capacity > 0 && Capacity < TIMECALENDAR_NONE, "timecalendar capacity must be 1..254");
+
+public:
+  timecalendar()
+    : timecalendarbase(_storage, Capacity) {}  /**< Default constructor. */
+
+private:
+  entry _storage[Capacity];  /**< Entry storage. */
+};
+
+#endif  // TIMECALENDAR_H
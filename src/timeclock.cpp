@@ -0,0 +1,101 @@
+/**
+ * @file timeclock.cpp
+ * @brief 64-bit monotonic millisecond and microsecond clock. The millisecond wrap counter 
+ * is updated from the scheduler tick; the microsecond wrap count is derived from it.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timeclock.h"
+#include "timeplatform.h"
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#elif defined(ARDUINO_ARCH_RP2040)
+#include <hardware/timer.h>
+#endif
+
+uint32_t timeclock::_msHigh = 0;
+uint32_t timeclock::_msLast = 0;
+uint32_t timeclock::_seconds = 0;
+uint32_t timeclock::_secondMark = 0;
+
+#if defined(ESP32)
+
+uint64_t timeclock::millis64() {
+  return (uint64_t)esp_timer_get_time() / 1000;
+}
+
+uint64_t timeclock::micros64() {
+  return (uint64_t)esp_timer_get_time();
+}
+
+#elif defined(ARDUINO_ARCH_RP2040)
+
+uint64_t timeclock::millis64() {
+  return time_us_64() / 1000;
+}
+
+uint64_t timeclock::micros64() {
+  return time_us_64();
+}
+
+#else
+
+uint64_t timeclock::millis64() {
+  uint32_t now = millis();
+  uint32_t high;
+  uint32_t last;
+  {
+    timecriticalsection lock;  // Consistent pair, even against an update() we interrupted
+    high = _msHigh;
+    last = _msLast;
+  }
+  if (now < last) high++;      // Wrapped since the last update
+  return ((uint64_t)high << 32) | now;
+}
+
+uint64_t timeclock::micros64() {
+  uint32_t low = micros();
+  uint64_t estimate = millis64() * 1000;           // Within a few ms of the true value
+  uint64_t value = (estimate & 0xFFFFFFFF00000000ULL) | low;
+  if (value > estimate + 0x80000000ULL) {
+    value -= 0x100000000ULL;                       // low belongs to the previous wrap
+  } else if (value + 0x80000000ULL < estimate) {
+    value += 0x100000000ULL;                       // low already wrapped
+  }
+  return value;
+}
+
+#endif
+
+void timeclock::update(uint32_t now) {
+  timecriticalsection lock;  // Readers in interrupts must never see a half update
+  if (now < _msLast) _msHigh++;
+  _msLast = now;
+  advanceSeconds(now);
+}
+
+uint32_t timeclock::seconds() {
+  uint32_t now = millis();
+  timecriticalsection lock;
+  advanceSeconds(now);
+  return _seconds;
+}
+
+// Called inside a critical section.
+void timeclock::advanceSeconds(uint32_t now) {
+  uint32_t delta = now - _secondMark;
+  if (delta < 1000) return;                // Same second: the common case
+  uint32_t whole = (delta < 2000) ? 1 : toSeconds(delta);
+  _seconds += whole;
+  _secondMark += whole * 1000;
+}
+
+uint32_t timeclock::epochOf(uint32_t ms) {
+  uint64_t now = millis64();
+  uint32_t high = now >> 32;
+  return (ms > (uint32_t)now) ? high - 1 : high;  // Taken before the current wrap
+}
@@ -0,0 +1,127 @@
+/**
+ * @file timeclock.h
+ * @brief Header file for the timeclock class.
+ * This file declares the 64-bit, rollover-safe extension of millis() and micros().
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMECLOCK_H
+#define TIMECLOCK_H
+
+#include "timearduino.h"
+
+/**
+ * @brief Monotonic 64-bit clock built on top of the 32-bit millis() and micros().
+ * 
+ * millis() wraps every 49.7 days and micros() every 71.6 minutes. timeclock extends 
+ * millis() with a wrap counter that update() maintains: it must run at least once per 
+ * 49.7 days, which timescheduler::tick() does on every pass. micros64() needs no state 
+ * of its own: its wrap count is recovered from millis64(). On ESP32 and RP2040 the 
+ * native 64-bit hardware timer is used directly.
+ * 
+ * Reads never modify the clock and are safe from interrupt context. The 32-bit values 
+ * remain the right choice for short intervals; use the 64-bit ones for uptimes and 
+ * deadlines that can be more than ~24 days away.
+ */
+class timeclock {
+public:
+  /**
+   * @brief Get the milliseconds since startup, without rollover.
+   * 
+   * On AVR, SAMD and the other cores without a 64-bit hardware timer, the count is only 
+   * right if timescheduler::tick() or update() ran at least once in the last 49.7 days; 
+   * a longer gap loses a whole wrap.
+   * 
+   * @return The 64-bit millisecond count.
+   */
+  static uint64_t millis64();
+
+  /**
+   * @brief Get the microseconds since startup, without rollover.
+   * 
+   * Derived from millis64(), with the same upkeep rule on cores without a 64-bit timer.
+   * 
+   * @return The 64-bit microsecond count.
+   */
+  static uint64_t micros64();
+
+  /**
+   * @brief Get the seconds since startup, without rollover (136 years of range).
+   * 
+   * Maintained incrementally: a call within the same second is one subtract and compare, 
+   * with no 64-bit (or 32-bit) division. Like millis64(), it relies on seconds() or 
+   * update() running at least once per 49.7 days.
+   * 
+   * @return The second count.
+   */
+  static uint32_t seconds();
+
+  /**
+   * @brief Convert milliseconds to whole seconds without a division.
+   * 
+   * Multiplies by a fixed-point reciprocal of 1000, exact for every 32-bit value. Much 
+   * cheaper than a division on cores without a hardware divider (AVR).
+   * 
+   * @param ms The time in milliseconds.
+   * @return The time in seconds, truncated.
+   */
+  static inline uint32_t toSeconds(uint32_t ms) {
+    return ((uint64_t)ms * 274877907UL) >> 38;  // ceil(2^38 / 1000)
+  }
+
+  /**
+   * @brief Account for millis() rollovers. Call at least once per 49.7 days (tick() does).
+   */
+  static inline void update() {
+    update(millis());
+  }
+
+  /**
+   * @brief Account for millis() rollovers from a timestamp captured by the caller.
+   * @param now The current millis() value.
+   */
+  static void update(uint32_t now);
+
+  /**
+   * @brief Get the wrap count (high word) of a recent millis() value.
+   * 
+   * Used to extend a stored 32-bit reference to 64 bits. The value must not be in the 
+   * future and must be less than 49.7 days old.
+   * 
+   * @param ms A millis() value at or before the current time.
+   * @return The high 32 bits of the 64-bit millisecond count at that time.
+   */
+  static uint32_t epochOf(uint32_t ms);
+
+  /**
+   * @brief Check if a 64-bit deadline has been reached.
+   * @param deadline The deadline in milliseconds, on the millis64() timebase.
+   * @return True if millis64() is at or past the deadline.
+   */
+  static inline bool reached64(uint64_t deadline) {
+    return millis64() >= deadline;
+  }
+
+  /**
+   * @brief Get the time left before a 64-bit deadline.
+   * @param deadline The deadline in milliseconds, on the millis64() timebase.
+   * @return The remaining time in milliseconds, 0 if the deadline has passed.
+   */
+  static inline uint64_t remaining64(uint64_t deadline) {
+    uint64_t now = millis64();
+    return (now < deadline) ? (deadline - now) : 0;
+  }
+
+private:
+  static uint32_t _msHigh;      /**< Number of millis() rollovers seen by update(). */
+  static uint32_t _msLast;      /**< millis() value at the last update(). */
+  static uint32_t _seconds;     /**< Whole seconds counted by seconds() and update(). */
+  static uint32_t _secondMark;  /**< millis() value at which _seconds last ticked. */
+
+  static void advanceSeconds(uint32_t now);
+};
+
+#endif  // TIMECLOCK_H
@@ -10,60 +10,239 @@
  */
 
 #include "timecontrol.h"
+#include "timescheduler.h"
+#include "timeplatform.h"
+#include "timecounter.h"
 
 char timecontrol::_buffer[16];
-timecontrol* timecontrol::_instance = nullptr;
+timecontrol* timecontrol::_firstInstance = nullptr;
+timecontrol* volatile timecontrol::_isrInstances[TIMECONTROL_MAX_INTERRUPTS] = {};
+timecontrol::interruptevent timecontrol::_isrQueue[TIMECONTROL_ISR_QUEUE_SIZE];
+volatile uint8_t timecontrol::_isrHead = 0;
+volatile uint8_t timecontrol::_isrTail = 0;
+volatile uint16_t timecontrol::_isrOverflows = 0;
 
+const uint16_t TIMECONTROL_STATE_MAGIC = 0x5443 ^ sizeof(timestate);  // "TC", changes with the layout
+
+static_assert(TIMECONTROL_ISR_QUEUE_SIZE >= 2 && TIMECONTROL_ISR_QUEUE_SIZE <= 128 && 
+              (TIMECONTROL_ISR_QUEUE_SIZE & (TIMECONTROL_ISR_QUEUE_SIZE - 1)) == 0,
+              "TIMECONTROL_ISR_QUEUE_SIZE must be a power of two between 2 and 128");
 timecontrol::timecontrol() 
   : _timelapse(0), _state(true), pMillis(0), _count(0), _callback(nullptr), 
     _startTime(millis()), _repeatCount(0), _pMicros(0), _lastElapsedTime(0), 
-    _elapsedCallback(nullptr), _useElapsedFirst(false), _elapsedIndex(0) {
+    _elapsedCallback(nullptr), _useElapsedFirst(false), _elapsedIndex(0), 
+    _scheduler(nullptr), _deadline(0), _slack(0), _heapIndex(TIMESCHEDULER_NONE), _rekeyPending(false), _windowed(false), _hires(false), 
+    _nextInstance(nullptr), _interruptSlot(TIMECONTROL_NO_INTERRUPT), _deferInterrupts(false), _counter(nullptr), 
+    _fixedRate(false), _catchUp(CatchUpFire), _missed(0), _missedCallback(nullptr), 
+    _secLapse(0), _secReference(0), _next(nullptr), _sequence(0), 
+    _timelapseHigh(0), _longReference(0), _referenceHigh(0), _longArmed(false) {
   pMillis = _startTime;
+  _startHigh = timeclock::epochOf(_startTime);
   _pMicros = micros();
-  _instance = this;
-  memset(_elapsedTimes, 0, sizeof(_elapsedTimes));  // Initialize the buffer
+  invalidateSeconds();
+  link();
+  clearStats();  // Initialize the history buffer and running statistics
 }
 
 timecontrol::timecontrol(uint32_t timelapse) 
   : _timelapse(timelapse), _state(true), pMillis(0), _count(0), _callback(nullptr), 
     _startTime(millis()), _repeatCount(0), _pMicros(0), _lastElapsedTime(0), 
-    _elapsedCallback(nullptr), _useElapsedFirst(false), _elapsedIndex(0) {
+    _elapsedCallback(nullptr), _useElapsedFirst(false), _elapsedIndex(0), 
+    _scheduler(nullptr), _deadline(0), _slack(0), _heapIndex(TIMESCHEDULER_NONE), _rekeyPending(false), _windowed(false), _hires(false), 
+    _nextInstance(nullptr), _interruptSlot(TIMECONTROL_NO_INTERRUPT), _deferInterrupts(false), _counter(nullptr), 
+    _fixedRate(false), _catchUp(CatchUpFire), _missed(0), _missedCallback(nullptr), 
+    _secLapse(0), _secReference(0), _next(nullptr), _sequence(0), 
+    _timelapseHigh(0), _longReference(0), _referenceHigh(0), _longArmed(false) {
   pMillis = _startTime;
+  _startHigh = timeclock::epochOf(_startTime);
   _pMicros = micros();
-  _instance = this;
-  memset(_elapsedTimes, 0, sizeof(_elapsedTimes));
+  invalidateSeconds();
+  link();
+  clearStats();
 }
 
 timecontrol::timecontrol(uint32_t timelapse, bool state, uint32_t previousMillis) 
   : _timelapse(timelapse), _state(state), pMillis(previousMillis), _count(0), 
     _callback(nullptr), _startTime(millis()), _repeatCount(0), _pMicros(0), 
-    _lastElapsedTime(0), _elapsedCallback(nullptr), _useElapsedFirst(false), _elapsedIndex(0) {
+    _lastElapsedTime(0), _elapsedCallback(nullptr), _useElapsedFirst(false), _elapsedIndex(0), 
+    _scheduler(nullptr), _deadline(0), _slack(0), _heapIndex(TIMESCHEDULER_NONE), _rekeyPending(false), _windowed(false), _hires(false), 
+    _nextInstance(nullptr), _interruptSlot(TIMECONTROL_NO_INTERRUPT), _deferInterrupts(false), _counter(nullptr), 
+    _fixedRate(false), _catchUp(CatchUpFire), _missed(0), _missedCallback(nullptr), 
+    _secLapse(0), _secReference(0), _next(nullptr), _sequence(0), 
+    _timelapseHigh(0), _longReference(0), _referenceHigh(0), _longArmed(false) {
+  _startHigh = timeclock::epochOf(_startTime);
   _pMicros = micros();
-  _instance = this;
-  memset(_elapsedTimes, 0, sizeof(_elapsedTimes));
+  invalidateSeconds();
+  link();
+  clearStats();
 }
 
-bool timecontrol::elapsed() {
+timecontrol::~timecontrol() {
+  detachInterrupt();
+  if (_scheduler) _scheduler->remove(*this);
+  unlink();
+}
+
+void timecontrol::link() {
+  _nextInstance = _firstInstance;
+  _firstInstance = this;
+}
+
+void timecontrol::unlink() {
+  timecontrol** it = &_firstInstance;
+  while (*it) {
+    if (*it == this) {
+      *it = _nextInstance;
+      continue;
+    }
+    if ((*it)->_next == this) (*it)->_next = nullptr;  // No chain keeps a dangling stage
+    it = &(*it)->_nextInstance;
+  }
+}
+
+void timecontrol::startNext(uint32_t now, bool inInterrupt) {
+  timecontrol* next = _next;
+  if (!next) return;
+  next->beginWrite();
+  next->pMillis = now;  // The next stage starts exactly when this one completed
+  next->_pMicros = micros();
+  next->_count = 0;
+  next->_lastElapsedTime = 0;
+  next->clearStats();  // As reset(): the stage statistics only cover this run
+  next->_state = true;
+  next->endWrite();
+  if (inInterrupt) {
+    next->requestReschedule();
+  } else if (next->_scheduler) {
+    next->reschedule();
+  }
+}
+
+// Shared by every timebase: Base only selects the reference and the unit at compile time,
+// so each public entry point instantiates just its own comparison.
+template <TimeBase Base>
+inline bool timecontrol::poll(uint32_t current, bool inInterrupt) {
   if (!_state) return false;
-  uint32_t current = millis();
-  if (current - pMillis >= _timelapse) {
-    _lastElapsedTime = current - pMillis;
-    pMillis = current;
-    _pMicros = micros();
-    _elapsedTimes[_elapsedIndex] = _lastElapsedTime;
-    _elapsedIndex = (_elapsedIndex + 1) % 10;  // Circular buffer
-    _count++;
-    if (_useElapsedFirst) {
-      if (_elapsedCallback) _elapsedCallback(_lastElapsedTime);
-      if (_callback) _callback();
-    } else {
-      if (_callback) _callback();
-      if (_elapsedCallback) _elapsedCallback(_lastElapsedTime);
+  uint32_t& reference = (Base == TimeBaseMicros) ? _pMicros : pMillis;
+  uint32_t elapsedTime;
+  if (Base == TimeBaseSeconds) {
+    if (reference != _secReference) armSeconds();    // Divides only once per period
+    if (current - reference < _secLapse) return false;
+    uint32_t phase = reference - timeclock::toSeconds(reference) * 1000;
+    elapsedTime = timeclock::toSeconds(current - reference + phase) * 1000;  // Whole seconds crossed
+  } else {
+    elapsedTime = current - reference;
+    if (_timelapseHigh == 0) {
+      if (elapsedTime < _timelapse) return false;  // The hot path: a single 32-bit compare
+      if (Base == TimeBaseMicros) elapsedTime /= 1000;
+    } else if (!dueLong(reference, current, Base == TimeBaseMicros, elapsedTime)) {
+      return false;
     }
-    if (_repeatCount > 0 && _count >= _repeatCount) stop();
-    return true;
   }
-  return false;
+#if TIMECONTROL_PROFILER
+  uint32_t lateness = current - reference - ((Base == TimeBaseSeconds) ? _secLapse : _timelapse);
+  if (_timelapseHigh > 0) lateness = 0;  // Not measured on 64-bit timelapses
+  uint32_t period = _timelapse;
+  if (Base != TimeBaseMicros) {
+    lateness = timeprofile::toMicros(lateness);
+    period = timeprofile::toMicros(period);
+  }
+#endif
+  beginWrite();  // Closed by fire() once the count is updated
+  reference = (_timelapseHigh > 0) ? _longReference : nextReference(reference, current);  // dueLong() computed it
+  if (Base == TimeBaseMicros) pMillis = millis();  // Keeps the millisecond queries meaningful
+#if TIMECONTROL_PROFILER
+  uint32_t started = micros();
+#endif
+  fire(elapsedTime);
+#if TIMECONTROL_PROFILER
+  _profile.record(micros() - started, period, lateness);
+#endif
+  if (_repeatCount > 0 && _count >= _repeatCount) {
+    _state = false;
+    startNext((Base == TimeBaseMicros) ? millis() : current, inInterrupt);
+  }
+  if (inInterrupt) {
+    requestReschedule();  // The heap is only touched by tick()
+  } else if (_scheduler) {
+    reschedule();
+  }
+  return true;
+}
+
+bool timecontrol::dueLong(uint32_t reference, uint32_t current, bool inMicros, uint32_t& elapsedTime) {
+  uint64_t clock = inMicros ? timeclock::micros64() : timeclock::millis64();
+  uint64_t now = widen(clock, current);
+  if (!_longArmed || reference != _longReference) {  // Moved by reset(), resume()...: it is recent
+    _longReference = reference;
+    _referenceHigh = (uint32_t)(extendReference(now, reference) >> 32);
+    _longArmed = true;
+  }
+  uint64_t start = (((uint64_t)_referenceHigh) << 32) | reference;
+  uint64_t timelapse = getTimelapse64();
+  if (now < start || now - start < timelapse) return false;
+  uint64_t next = _fixedRate ? start + timelapse : now;  // Whole missed periods are not counted
+  _missed = 0;
+  _longReference = (uint32_t)next;
+  _referenceHigh = (uint32_t)(next >> 32);
+  uint64_t elapsed = inMicros ? (now - start) / 1000 : now - start;
+  elapsedTime = (elapsed > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)elapsed;
+  return true;
+}
+
+uint64_t timecontrol::remainingLong(uint32_t now, bool inMicros) const {
+  if (!_state) return 0;
+  uint64_t current = widen(inMicros ? timeclock::micros64() : timeclock::millis64(), now);
+  uint32_t reference = inMicros ? _pMicros : pMillis;
+  uint64_t start = (_longArmed && reference == _longReference) ? ((((uint64_t)_referenceHigh) << 32) | reference) 
+                                                               : extendReference(current, reference);
+  uint64_t deadline = start + getTimelapse64();
+  return (current < deadline) ? deadline - current : 0;
+}
+
+void timecontrol::armSeconds() {
+  uint32_t phase = pMillis - timeclock::toSeconds(pMillis) * 1000;  // Offset into the current second
+  uint32_t timelapseSec = timeclock::toSeconds(_timelapse);
+  _secLapse = (timelapseSec > 0) ? timelapseSec * 1000 - phase : 0;  // Up to the target boundary
+  _secReference = pMillis;
+}
+
+void timecontrol::fire(uint32_t elapsedTime) {
+  _lastElapsedTime = elapsedTime;
+  recordElapsed(elapsedTime);
+  _count++;
+  endWrite();  // Opened by the caller before it moved the reference
+  if (_counter) _counter->latch(millis());  // The gate ends now, read next to the edge count
+  if (_useElapsedFirst) {
+    if (_elapsedCallback) _elapsedCallback(elapsedTime);
+    if (_callback) _callback();
+  } else {
+    if (_callback) _callback();
+    if (_elapsedCallback) _elapsedCallback(elapsedTime);
+  }
+  _delegate(elapsedTime);
+  if (_missed > 0 && _catchUp == CatchUpCoalesce && _missedCallback) _missedCallback(_missed);
+}
+
+bool timecontrol::elapsed() {
+  return elapsed(millis());
+}
+
+bool timecontrol::elapsed(uint32_t current) {
+  return poll<TimeBaseMillis>(current);
+}
+
+uint32_t timecontrol::nextReference(uint32_t reference, uint32_t current) {
+  _missed = 0;
+  if (!_fixedRate || _timelapse == 0) {
+    // Fixed delay: restart from now, but lateness within the slack does not shift the phase
+    return (current - reference - _timelapse <= _slack) ? reference + _timelapse : current;
+  }
+  uint32_t behind = current - reference - _timelapse;  // Lateness past this deadline
+  if (behind < _timelapse) return reference + _timelapse;
+  _missed = behind / _timelapse;                       // Only divides when whole periods were missed
+  if (_catchUp == CatchUpFire) return reference + _timelapse;
+  return reference + _timelapse * (_missed + 1);       // Next slot on the original grid
 }
 
 void timecontrol::elapsedExec(void (*function)(void)) {
@@ -73,49 +252,67 @@ void timecontrol::elapsedExec(void (*function)(void)) {
 }
 
 char* timecontrol::secToTime(uint32_t sec) const {
-  uint16_t days = sec / SECONDS_PER_DAY;
-  uint8_t hours = (sec % SECONDS_PER_DAY) / SECONDS_PER_HOUR;
-  uint8_t minutes = (sec % SECONDS_PER_HOUR) / SECONDS_PER_MINUTE;
-  uint8_t seconds = sec % SECONDS_PER_MINUTE;
+  return secToTime(sec, _buffer, sizeof(_buffer));
+}
 
-  if (days > 0) {
-    snprintf(_buffer, sizeof(_buffer), "%d:%02d:%02d:%02d", days, hours, minutes, seconds);
-  } else {
-    snprintf(_buffer, sizeof(_buffer), "%02d:%02d:%02d", hours, minutes, seconds);
+char* timecontrol::secToTime(uint32_t sec, char* buffer, uint8_t bufferSize) {
+  char text[TIMECONTROL_TIME_STRING_SIZE];
+  return copyText(buffer, bufferSize, text, formatDuration(text, sec, 0, false));
+}
+
+size_t timecontrol::printTime(Print& out, uint32_t sec) {
+  char text[TIMECONTROL_TIME_STRING_SIZE];
+  return out.write((const uint8_t*)text, formatDuration(text, sec, 0, false));
+}
+
+uint8_t timecontrol::formatDuration(char* out, uint32_t sec, uint16_t milliseconds, bool withMillis) {
+  char* p = out;
+  if (sec >= SECONDS_PER_DAY) {
+    uint16_t days = sec / SECONDS_PER_DAY;  // The only 32-bit division, and only past one day
+    sec -= (uint32_t)days * SECONDS_PER_DAY;
+    char digits[5];
+    uint8_t n = 0;
+    do {
+      digits[n++] = '0' + days % 10;
+      days /= 10;
+    } while (days > 0);
+    while (n > 0) *p++ = digits[--n];
+    *p++ = ':';
+  }
+  uint8_t hours = 0;
+  while (sec >= SECONDS_PER_HOUR) {  // At most 23 subtractions
+    sec -= SECONDS_PER_HOUR;
+    hours++;
   }
-  return _buffer;
+  uint16_t rest = sec;               // Below one hour: 16-bit arithmetic from here on
+  uint8_t minutes = rest / SECONDS_PER_MINUTE;
+  uint8_t seconds = rest - minutes * SECONDS_PER_MINUTE;
+  const uint8_t fields[3] = { hours, minutes, seconds };
+  for (uint8_t i = 0; i < 3; i++) {
+    if (i > 0) *p++ = ':';
+    *p++ = '0' + fields[i] / 10;
+    *p++ = '0' + fields[i] % 10;
+  }
+  if (withMillis) {
+    *p++ = '.';
+    *p++ = '0' + milliseconds / 100;
+    *p++ = '0' + (milliseconds / 10) % 10;
+    *p++ = '0' + milliseconds % 10;
+  }
+  *p = '\0';
+  return p - out;
 }
 
-uint32_t timecontrol::remainingTime() {
-  if (!_state || elapsed()) return 0;
-  uint32_t current = millis();
-  uint32_t elapsedTime = current - pMillis;
-  return (elapsedTime < _timelapse) ? (_timelapse - elapsedTime) : 0;
+char* timecontrol::copyText(char* buffer, uint8_t bufferSize, const char* text, uint8_t length) {
+  if (bufferSize == 0) return buffer;
+  if (length >= bufferSize) length = bufferSize - 1;  // Truncate like snprintf
+  memcpy(buffer, text, length);
+  buffer[length] = '\0';
+  return buffer;
 }
 
 bool timecontrol::elapsedSeconds() {
-  if (!_state) return false;
-  uint32_t currentSec = millis() / 1000;
-  uint32_t previousSec = pMillis / 1000;
-  uint32_t timelapseSec = _timelapse / 1000;
-  if (currentSec - previousSec >= timelapseSec) {
-    pMillis = millis();
-    _pMicros = micros();
-    _lastElapsedTime = (currentSec - previousSec) * 1000;
-    _elapsedTimes[_elapsedIndex] = _lastElapsedTime;
-    _elapsedIndex = (_elapsedIndex + 1) % 10;
-    _count++;
-    if (_useElapsedFirst) {
-      if (_elapsedCallback) _elapsedCallback(_lastElapsedTime);
-      if (_callback) _callback();
-    } else {
-      if (_callback) _callback();
-      if (_elapsedCallback) _elapsedCallback(_lastElapsedTime);
-    }
-    if (_repeatCount > 0 && _count >= _repeatCount) stop();
-    return true;
-  }
-  return false;
+  return poll<TimeBaseSeconds>(millis());
 }
 
 void timecontrol::pauseAndResumeLater(uint32_t& elapsedOut) {
@@ -123,103 +320,351 @@ void timecontrol::pauseAndResumeLater(uint32_t& elapsedOut) {
     elapsedOut = getElapsedTime();
     stop();
   } else if (elapsedOut > 0) {
+    beginWrite();
     pMillis = millis() - elapsedOut;
+    endWrite();
     _pMicros = micros();
-    resume();
+    resume();  // Re-keys the timer with the restored reference
     elapsedOut = 0;
   }
 }
 
 bool timecontrol::elapsedMicros() {
-  if (!_state) return false;
-  uint32_t current = micros();
-  if (current - _pMicros >= _timelapse) {
-    _lastElapsedTime = (current - _pMicros) / 1000;
-    _pMicros = current;
-    pMillis = millis();
-    _elapsedTimes[_elapsedIndex] = _lastElapsedTime;
-    _elapsedIndex = (_elapsedIndex + 1) % 10;
-    _count++;
-    if (_useElapsedFirst) {
-      if (_elapsedCallback) _elapsedCallback(_lastElapsedTime);
-      if (_callback) _callback();
-    } else {
-      if (_callback) _callback();
-      if (_elapsedCallback) _elapsedCallback(_lastElapsedTime);
-    }
-    if (_repeatCount > 0 && _count >= _repeatCount) stop();
-    return true;
+  return elapsedMicros(micros());
+}
+
+bool timecontrol::elapsedMicros(uint32_t current) {
+  return poll<TimeBaseMicros>(current);
+}
+
+bool timecontrol::elapsedMicrosFromInterrupt(uint32_t current) {
+  return poll<TimeBaseMicros>(current, true);
+}
+
+template <uint8_t Slot>
+void timecontrol::interruptTrampoline() {
+  interruptHandler(_isrInstances[Slot]);
+}
+
+template <>
+timecontrol::isrfunc timecontrol::trampolineFor<TIMECONTROL_MAX_INTERRUPTS>(uint8_t) {
+  return nullptr;
+}
+
+template <uint8_t Slot>
+timecontrol::isrfunc timecontrol::trampolineFor(uint8_t slot) {
+  return (slot == Slot) ? &interruptTrampoline<Slot> : trampolineFor<Slot + 1>(slot);
+}
+
+bool timecontrol::attachInterrupt(uint8_t pin, uint8_t mode, bool deferred) {
+  return attachSlot(pin, mode, deferred, nullptr);
+}
+
+bool timecontrol::attachCounter(timecounter& counter, uint8_t pin, uint8_t mode) {
+  return attachSlot(pin, mode, false, &counter);
+}
+
+bool timecontrol::attachSlot(uint8_t pin, uint8_t mode, bool deferred, timecounter* counter) {
+  int interrupt = digitalPinToInterrupt(pin);
+  if (interrupt < 0 || interrupt >= TIMECONTROL_MAX_INTERRUPTS) return false;
+  uint8_t slot = (uint8_t)interrupt;
+  if (_interruptSlot != slot) detachInterrupt();
+  timecontrol* previous = _isrInstances[slot];
+  if (previous && previous != this) {
+    previous->_interruptSlot = TIMECONTROL_NO_INTERRUPT;
+    previous->_counter = nullptr;
+  }
+  _isrInstances[slot] = this;
+  _interruptSlot = slot;
+  _deferInterrupts = deferred;
+  _counter = counter;
+  if (counter) counter->_lastLatch = millis();  // The first gate starts with the counting
+  ::attachInterrupt(slot, trampolineFor<0>(slot), mode);
+  if (counter) {
+    timeplatform::disableWakeInterrupt(slot);  // Pulses are only counted, they never wake
+  } else {
+    timeplatform::enableWakeInterrupt(slot, mode);
   }
-  return false;
+  return true;
 }
 
-void timecontrol::attachInterrupt(uint8_t pin, uint8_t mode) {
-  ::attachInterrupt(digitalPinToInterrupt(pin), interruptHandler, mode);
+void timecontrol::detachInterrupt() {
+  if (_interruptSlot == TIMECONTROL_NO_INTERRUPT) return;
+  ::detachInterrupt(_interruptSlot);
+  timeplatform::disableWakeInterrupt(_interruptSlot);
+  _isrInstances[_interruptSlot] = nullptr;
+  _interruptSlot = TIMECONTROL_NO_INTERRUPT;
+  _counter = nullptr;
+}
+
+void timecontrol::interruptHandler(timecontrol* instance) {
+  if (!instance) return;
+  if (instance->_counter) {
+    instance->_counter->count();  // Counting mode: no clock read, no bookkeeping, no wake-up
+    return;
+  }
+  if (!instance->_callback && !instance->_delegate) return;
+  timeplatform::wake();  // Let a sleeping scheduler handle the event
+  if (!instance->_deferInterrupts) {
+    instance->handleInterruptEvent(millis(), true);
+    return;
+  }
+  uint8_t head = _isrHead;
+  if ((uint8_t)(head - _isrTail) >= TIMECONTROL_ISR_QUEUE_SIZE) {
+    _isrOverflows++;
+    return;
+  }
+  interruptevent& event = _isrQueue[head & (TIMECONTROL_ISR_QUEUE_SIZE - 1)];
+  event.slot = instance->_interruptSlot;
+  event.time = millis();
+  TIMECONTROL_BARRIER();  // Publish the entry before the new head
+  _isrHead = head + 1;
 }
 
-void timecontrol::interruptHandler() {
-  if (_instance && _instance->_callback) {
-    _instance->_count++;
-    _instance->_lastElapsedTime = _instance->getElapsedTime();
-    _instance->pMillis = millis();
-    _instance->_pMicros = micros();
-    if (_instance->_useElapsedFirst) {
-      if (_instance->_elapsedCallback) _instance->_elapsedCallback(_instance->_lastElapsedTime);
-      if (_instance->_callback) _instance->_callback();
+void timecontrol::handleInterruptEvent(uint32_t time, bool inInterrupt) {
+  uint32_t elapsedTime = _state ? (time - pMillis) : 0;
+  beginWrite();  // Closed by fire()
+  pMillis = time;
+  _pMicros = micros();
+  _missed = 0;  // Events are never late: nothing to coalesce
+#if TIMECONTROL_PROFILER
+  uint32_t started = micros();
+#endif
+  fire(elapsedTime);
+#if TIMECONTROL_PROFILER
+  _profile.record(micros() - started, 0, inInterrupt ? 0 : timeprofile::toMicros(millis() - time));
+#endif
+  bool finished = (_repeatCount > 0 && _count >= _repeatCount);
+  if (inInterrupt) {
+    if (finished) {
+      _state = false;
+      requestReschedule();
+      startNext(time, true);
     } else {
-      if (_instance->_callback) _instance->_callback();
-      if (_instance->_elapsedCallback) _instance->_elapsedCallback(_instance->_lastElapsedTime);
+      resumeFromInterrupt();
+    }
+  } else if (finished) {
+    stop();
+    startNext(time, false);
+  } else {
+    resume();  // Also re-keys the new reference in the scheduler
+  }
+}
+
+uint8_t timecontrol::processInterrupts() {
+  uint8_t processed = 0;
+  uint8_t tail = _isrTail;
+  while (tail != _isrHead) {
+    TIMECONTROL_BARRIER();  // Read the entry only after observing the head
+    interruptevent event = _isrQueue[tail & (TIMECONTROL_ISR_QUEUE_SIZE - 1)];
+    TIMECONTROL_BARRIER();  // Finish reading the entry before releasing the slot
+    _isrTail = ++tail;      // Released before running user code
+    timecontrol* instance = _isrInstances[event.slot];
+    if (instance) {
+      instance->handleInterruptEvent(event.time, false);
+      processed++;
     }
-    _instance->_elapsedTimes[_instance->_elapsedIndex] = _instance->_lastElapsedTime;
-    _instance->_elapsedIndex = (_instance->_elapsedIndex + 1) % 10;
-    if (_instance->_repeatCount > 0 && _instance->_count >= _instance->_repeatCount) 
-      _instance->stop();
-    else
-      _instance->resumeFromInterrupt();
   }
+  return processed;
+}
+
+uint16_t timecontrol::getInterruptOverflows() {
+  uint16_t overflows;
+  do {
+    overflows = _isrOverflows;
+  } while (overflows != _isrOverflows);  // Retry on a torn read instead of disabling interrupts
+  return overflows;
 }
 
 void timecontrol::wait(uint32_t duration) {
   uint32_t start = millis();
-  while (millis() - start < duration) {}
+  while (millis() - start < duration) timeplatform::idle();  // Sleep until the next tick instead of spinning
+}
+
+void timecontrol::formatElapsedTime(char* buffer, uint8_t bufferSize, bool withMillis) const {
+  uint32_t elapsedMs = getElapsedTime();
+  uint32_t elapsedSec = timeclock::toSeconds(elapsedMs);
+  char text[TIMECONTROL_TIME_STRING_SIZE];
+  uint8_t length = formatDuration(text, elapsedSec, elapsedMs - elapsedSec * 1000, withMillis);
+  copyText(buffer, bufferSize, text, length);
+}
+
+size_t timecontrol::printElapsedTime(Print& out, bool withMillis) const {
+  uint32_t elapsedMs = getElapsedTime();
+  uint32_t elapsedSec = timeclock::toSeconds(elapsedMs);
+  char text[TIMECONTROL_TIME_STRING_SIZE];
+  uint8_t length = formatDuration(text, elapsedSec, elapsedMs - elapsedSec * 1000, withMillis);
+  return out.write((const uint8_t*)text, length);
+}
+
+timesnapshot timecontrol::snapshot() const {
+  timesnapshot copy;
+  uint8_t sequence;
+  do {
+    sequence = _sequence;
+    TIMECONTROL_BARRIER();  // Read the fields only after the count
+    copy.count = _count;
+    copy.lastElapsedTime = _lastElapsedTime;
+    copy.reference = pMillis;
+    copy.running = _state;
+    TIMECONTROL_BARRIER();  // Finish reading the fields before checking the count again
+  } while ((sequence & 1) || sequence != _sequence);  // A write was in progress or happened meanwhile
+  return copy;
+}
+
+void timecontrol::save(timestate& out) const {
+  memset(&out, 0, sizeof(out));  // Padding included, so the checksum is reproducible
+  uint32_t now = millis();
+  out.timelapse = _timelapse;
+  out.phase = now - pMillis;
+  out.phaseMicros = micros() - _pMicros;
+  out.total = getTotalElapsedTime64();
+  out.count = _count;
+  out.repeatCount = _repeatCount;
+  out.lastElapsedTime = _lastElapsedTime;
+  out.slack = _slack;
+  out.historySum = _historySum;
+  out.minElapsed = _minElapsed;
+  out.maxElapsed = _maxElapsed;
+  out.meanElapsed = _meanElapsed;
+  out.m2Elapsed = _m2Elapsed;
+  memcpy(out.history, _elapsedTimes, sizeof(out.history));
+  out.historyIndex = _elapsedIndex;
+  out.flags = (_state ? 0x01 : 0) | (_fixedRate ? 0x02 : 0);
+  out.catchUp = _catchUp;
+  out.magic = TIMECONTROL_STATE_MAGIC;
+  out.check = checksum(out);
+}
+
+bool timecontrol::restore(const timestate& in, uint64_t sleptMicros) {
+  if (in.magic != TIMECONTROL_STATE_MAGIC || in.check != checksum(in)) return false;
+  uint32_t sleptMillis = (uint32_t)(sleptMicros / 1000);  // Once per wake, not per poll
+  uint32_t now = millis();
+  _timelapse = in.timelapse;
+  _timelapseHigh = 0;  // timestate keeps 32-bit timelapses
+  beginWrite();
+  pMillis = now - in.phase - sleptMillis;
+  _pMicros = micros() - in.phaseMicros - (uint32_t)sleptMicros;
+  _count = in.count;
+  _lastElapsedTime = in.lastElapsedTime;
+  _state = (in.flags & 0x01) != 0;
+  endWrite();
+  uint64_t start = timeclock::millis64() - in.total - sleptMillis;  // May precede this boot
+  _startTime = (uint32_t)start;
+  _startHigh = (uint32_t)(start >> 32);
+  _repeatCount = in.repeatCount;
+  _slack = in.slack;
+  _historySum = in.historySum;
+  _minElapsed = in.minElapsed;
+  _maxElapsed = in.maxElapsed;
+  _meanElapsed = in.meanElapsed;
+  _m2Elapsed = in.m2Elapsed;
+  memcpy(_elapsedTimes, in.history, sizeof(_elapsedTimes));
+  _elapsedIndex = in.historyIndex & TIMECONTROL_HISTORY_MASK;
+  _fixedRate = (in.flags & 0x02) != 0;
+  _catchUp = in.catchUp;
+  invalidateSeconds();
+  if (_scheduler) reschedule();
+  return true;
 }
 
-void timecontrol::formatElapsedTime(char* buffer, uint8_t bufferSize) const {
-  uint32_t elapsedSec = getElapsedTime() / 1000;
-  uint8_t hours = elapsedSec / SECONDS_PER_HOUR;
-  uint8_t minutes = (elapsedSec % SECONDS_PER_HOUR) / SECONDS_PER_MINUTE;
-  uint8_t seconds = elapsedSec % SECONDS_PER_MINUTE;
-  snprintf(buffer, bufferSize, "%02d:%02d:%02d", hours, minutes, seconds);
+uint16_t timecontrol::checksum(const timestate& state) {
+  const uint8_t* data = (const uint8_t*)&state.timelapse;  // Everything after magic and check
+  const uint8_t* end = (const uint8_t*)&state + sizeof(state);
+  uint16_t sum1 = 0, sum2 = 0;
+  while (data < end) {  // Fletcher-16
+    sum1 = (sum1 + *data++) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (uint16_t)((sum2 << 8) | sum1);
 }
 
-uint32_t timecontrol::getAverageElapsedTime(uint8_t samples) {
-  if (samples > 10) samples = 10;  // Maximum 10 samples
+uint32_t timecontrol::getAverageElapsedTime(uint8_t samples) const {
   if (_count == 0) return 0;
+  uint8_t validSamples = (_count < TIMECONTROL_HISTORY_SIZE) ? (uint8_t)_count : TIMECONTROL_HISTORY_SIZE;
+  if (samples >= validSamples) return _historySum / validSamples;  // Whole window: running sum, O(1)
+  if (samples == 0) return 0;
   uint32_t sum = 0;
-  uint8_t validSamples = min(samples, _count);
-  for (uint8_t i = 0; i < validSamples; i++) {
-    uint8_t idx = (_elapsedIndex - 1 - i + 10) % 10;
-    sum += _elapsedTimes[idx];
+  for (uint8_t i = 1; i <= samples; i++) {
+    sum += _elapsedTimes[(uint8_t)(_elapsedIndex - i) & TIMECONTROL_HISTORY_MASK];
   }
-  return sum / validSamples;
+  return sum / samples;
+}
+
+void timecontrol::recordElapsed(uint32_t elapsedTime) {
+  _historySum += elapsedTime - _elapsedTimes[_elapsedIndex];  // Slot holds 0 until the window is full
+  _elapsedTimes[_elapsedIndex] = elapsedTime;
+  _elapsedIndex = (_elapsedIndex + 1) & TIMECONTROL_HISTORY_MASK;
+  if (elapsedTime < _minElapsed) _minElapsed = elapsedTime;
+  if (elapsedTime > _maxElapsed) _maxElapsed = elapsedTime;
+  float delta = (float)elapsedTime - _meanElapsed;  // Welford, n = _count + 1
+  _meanElapsed += delta / (float)(_count + 1);
+  _m2Elapsed += delta * ((float)elapsedTime - _meanElapsed);
+}
+
+void timecontrol::clearStats() {
+  memset(_elapsedTimes, 0, sizeof(_elapsedTimes));
+  _elapsedIndex = 0;
+  _historySum = 0;
+  _minElapsed = 0xFFFFFFFF;
+  _maxElapsed = 0;
+  _meanElapsed = 0;
+  _m2Elapsed = 0;
 }
 
 void timecontrol::pauseAll() {
-  if (_instance) _instance->stop();
+  for (timecontrol* it = _firstInstance; it; it = it->_nextInstance) it->stop();
+}
+
+#if TIMECONTROL_PROFILER
+size_t timecontrol::printProfiles(Print& out) {
+  size_t n = 0;
+  uint8_t index = 0;
+  for (timecontrol* it = _firstInstance; it; it = it->_nextInstance, index++) {
+    n += out.print('#');
+    n += out.print(index);
+    n += out.print(" period=");
+    n += out.print(it->_timelapse);
+    n += out.print(' ');
+    n += it->_profile.printTo(out);
+    n += out.println();
+  }
+  return n;
 }
+#endif
 
 uint32_t timecontrol::countdown(uint32_t duration, void (*callback)(void)) {
     if (!_state) {  // Start countdown if not running
+        beginWrite();
         pMillis = millis();
+        endWrite();
         _timelapse = duration;
+        _timelapseHigh = 0;
+        invalidateSeconds();
         _state = true;
+        if (_scheduler) reschedule();
     }
     
     uint32_t elapsed = millis() - pMillis;
     if (elapsed >= _timelapse) {
         _state = false;  // Stop when it reaches zero
+        if (_scheduler) reschedule();
         if (callback) callback();  // Execute callback if it exists
+        startNext(pMillis + _timelapse, false);
         return 0;
     }
     return _timelapse - elapsed;  // Return remaining time
 }
+
+void timecontrol::reschedule() {
+  _rekeyPending = false;
+  _scheduler->update(*this);
+}
+
+void timecontrol::requestReschedule() {
+  if (_scheduler) {
+    _rekeyPending = true;
+    _scheduler->_pending = true;
+    timeplatform::wake();  // A sleeping scheduler re-keys it now, not at its old deadline
+  }
+}
@@ -12,7 +12,51 @@
 #define TIMECONTROL_H
 
 //#include <stdint.h> included in Arduino.h
-#include <Arduino.h>
+#include "timearduino.h"
+#include "timeclock.h"
+#include "timedelegate.h"
+#include "timeprofile.h"
+
+/**
+ * @brief Size of the interrupt dispatch table (one slot per interrupt number).
+ * Can be overridden with a build flag to save RAM on boards with many interrupt-capable pins.
+ */
+#ifndef TIMECONTROL_MAX_INTERRUPTS
+#if defined(EXTERNAL_NUM_INTERRUPTS)
+#define TIMECONTROL_MAX_INTERRUPTS EXTERNAL_NUM_INTERRUPTS
+#elif defined(NUM_DIGITAL_PINS)
+#define TIMECONTROL_MAX_INTERRUPTS NUM_DIGITAL_PINS
+#else
+#define TIMECONTROL_MAX_INTERRUPTS 8
+#endif
+#endif
+
+/**
+ * @brief Number of entries in the deferred interrupt queue (power of two, 2..128).
+ */
+#ifndef TIMECONTROL_ISR_QUEUE_SIZE
+#define TIMECONTROL_ISR_QUEUE_SIZE 8
+#endif
+
+/**
+ * @brief Number of elapsed times kept for getAverageElapsedTime() (power of two, 2..128).
+ * 
+ * It sets the size of every timecontrol, so it must only be changed as a build flag: a 
+ * #define in the sketch would give the sketch and the library sources different layouts.
+ */
+#ifndef TIMECONTROL_HISTORY_SIZE
+#define TIMECONTROL_HISTORY_SIZE 16
+#endif
+#define TIMECONTROL_HISTORY_MASK (TIMECONTROL_HISTORY_SIZE - 1)  /**< Index mask for the history ring. */
+static_assert(TIMECONTROL_HISTORY_SIZE >= 2 && TIMECONTROL_HISTORY_SIZE <= 128 && 
+              (TIMECONTROL_HISTORY_SIZE & TIMECONTROL_HISTORY_MASK) == 0,
+              "TIMECONTROL_HISTORY_SIZE must be a power of two between 2 and 128");
+
+#if defined(__AVR__)
+#define TIMECONTROL_BARRIER() __asm__ __volatile__("" ::: "memory")  /**< Single core: compiler barrier is enough. */
+#else
+#define TIMECONTROL_BARRIER() __sync_synchronize()                   /**< Full memory barrier. */
+#endif
 
 /**
  * @brief Enumerates the direction of time conversion.
@@ -22,17 +66,85 @@ enum TimeDirection {
   SecondsToMilliseconds  /**< Convert seconds to milliseconds. */
 };
 
+/**
+ * @brief Enumerates what a fixed-rate timer does when polls are late by whole periods.
+ */
+enum CatchUpPolicy {
+  CatchUpFire,     /**< Fire every missed tick, one per poll, until back on schedule. */
+  CatchUpSkip,     /**< Fire once and skip to the next slot on the original grid. */
+  CatchUpCoalesce  /**< Fire once, skip to the next slot and pass the missed count to the missed callback. */
+};
+
+/**
+ * @brief Enumerates the timebase a polled timer compares its timelapse against.
+ */
+enum TimeBase {
+  TimeBaseMillis,   /**< millis(), timelapse in milliseconds (elapsed()). */
+  TimeBaseSeconds,  /**< millis() truncated to whole seconds (elapsedSeconds()). */
+  TimeBaseMicros    /**< micros(), timelapse in microseconds (elapsedMicros()). */
+};
+
+class timeschedulerbase;
+class timecounter;
+
+/**
+ * @brief Consistent copy of the event state of a timer, returned by timecontrol::snapshot().
+ */
+struct timesnapshot {
+  uint32_t count;            /**< Elapsed events since the last reset (elapsedCount()). */
+  uint32_t lastElapsedTime;  /**< Duration of the last event in milliseconds (getLastElapsedTime()). */
+  uint32_t reference;        /**< millis() value the current period started at. */
+  bool running;              /**< True if the timer is running (isRunning()). */
+};
+
+/**
+ * @brief Saved state of a timer, written by timecontrol::save() and read back by restore().
+ * 
+ * Plain data without pointers, meant to be kept in RTC memory (`RTC_DATA_ATTR` on ESP32), 
+ * EEPROM or flash across deep sleep and resets. Times are stored relative to the moment 
+ * of the save, so restore() only needs to know how long the MCU was away. A magic value 
+ * and a checksum let restore() reject a cold-boot (uninitialized) or stale copy.
+ */
+struct timestate {
+  uint16_t magic;                                  /**< Layout marker, 0 when never saved. */
+  uint16_t check;                                  /**< Fletcher-16 of the fields below. */
+  uint32_t timelapse;                              /**< Timelapse (ms, or us for elapsedMicros()). */
+  uint32_t phase;                                  /**< Milliseconds since the reference at the save. */
+  uint32_t phaseMicros;                            /**< Microseconds since the micros() reference at the save. */
+  uint64_t total;                                  /**< getTotalElapsedTime64() at the save. */
+  uint32_t count;                                  /**< Elapsed events. */
+  uint32_t repeatCount;                            /**< Configured repetitions. */
+  uint32_t lastElapsedTime;                        /**< Duration of the last event. */
+  uint32_t slack;                                  /**< Scheduler slack. */
+  uint32_t historySum;                             /**< Running sum of the history ring. */
+  uint32_t minElapsed;                             /**< Shortest event since reset. */
+  uint32_t maxElapsed;                             /**< Longest event since reset. */
+  float meanElapsed;                               /**< Running mean. */
+  float m2Elapsed;                                 /**< Running sum of squared deviations. */
+  uint32_t history[TIMECONTROL_HISTORY_SIZE];      /**< Elapsed history ring. */
+  uint8_t historyIndex;                            /**< Next history slot. */
+  uint8_t flags;                                   /**< Running and fixed-rate bits. */
+  uint8_t catchUp;                                 /**< CatchUpPolicy. */
+};
+
 // time constants
-const uint16_t SECONDS_PER_DAY = 86400; /**< The number of seconds in a day. */
+const uint32_t SECONDS_PER_DAY = 86400; /**< The number of seconds in a day. */
 const uint16_t SECONDS_PER_HOUR = 3600; /**< The number of seconds in an hour. */
 const uint8_t SECONDS_PER_MINUTE = 60;  /**< The number of seconds in a minute. */
 
+const uint8_t TIMESCHEDULER_NONE = 0xFF; /**< Heap index of a timer that is not armed in a scheduler. */
+const uint8_t TIMECONTROL_NO_INTERRUPT = 0xFF; /**< Interrupt slot of a timer that has no interrupt attached. */
+const uint8_t TIMECONTROL_TIME_STRING_SIZE = 20; /**< Buffer size that fits any formatted time ("DDDDD:HH:MM:SS.mmm"). */
+
 class timecontrol {
 public:
   timecontrol();                                                        /**< Default constructor. */
   timecontrol(uint32_t timelapse);                                      /**< Constructor with timelapse parameter. */
   timecontrol(uint32_t timelapse, bool state, uint32_t previousMillis); /**< Constructor with timelapse, state, and previousMillis parameters. */
-  ~timecontrol(){};                                                     /**< Destructor. */
+  ~timecontrol();                                                       /**< Destructor (detaches the interrupt and unregisters the timer). */
+
+  timecontrol(const timecontrol&) = delete;             /**< Not copyable: instances are linked into the global instance list. */
+  timecontrol& operator=(const timecontrol&) = delete;  /**< Not assignable. */
 
   /**
    * @brief Get the timelapse value.
@@ -48,6 +160,7 @@ public:
    */
   inline void setState(bool state) {
     _state = state;
+    if (_scheduler) reschedule();
   }
 
   /**
@@ -63,6 +176,7 @@ public:
    */
   inline void stop() {
     _state = false;
+    if (_scheduler) reschedule();
   }
 
   /**
@@ -70,6 +184,7 @@ public:
    */
   inline void resume() {
     _state = true;
+    if (_scheduler) reschedule();
   }
 
   /**
@@ -78,6 +193,17 @@ public:
    */
   bool elapsed();
 
+  /**
+   * @brief Check if the timelapse has elapsed against a timestamp captured by the caller.
+   * 
+   * Same behaviour as elapsed(), but the current time is passed in instead of being read 
+   * again with millis(). Useful when many timers are polled from a single clock read.
+   * 
+   * @param now The current time in milliseconds (as returned by millis()).
+   * @return True if the timelapse has elapsed, false otherwise.
+   */
+  bool elapsed(uint32_t now);
+
   /**
    * @brief Execute a function if the timelapse has elapsed.
    * @param function The function to execute.
@@ -86,17 +212,47 @@ public:
 
   /**
    * @brief Convert seconds to time format (HH:MM:SS).
+   * 
+   * The result is stored in a static buffer shared by secToTime(), printRunTime() and 
+   * printTime(), so it is overwritten by the next call. Use the caller-buffer or Print& 
+   * overloads when two times are needed at once, or from interrupts and other tasks.
+   * 
    * @param sec The time in seconds.
    * @return A character array representing the time in HH:MM:SS format.
    */
   char* secToTime(uint32_t sec) const;
 
+  /**
+   * @brief Convert seconds to time format (HH:MM:SS or D:HH:MM:SS) into a caller-provided buffer.
+   * 
+   * Reentrant and allocation-free; the text is truncated to fit the buffer, which is 
+   * always null-terminated. TIMECONTROL_TIME_STRING_SIZE bytes fit any value.
+   * 
+   * @param sec The time in seconds.
+   * @param buffer Pointer to the character array where the formatted time will be stored.
+   * @param bufferSize Size of the buffer in bytes.
+   * @return The buffer.
+   */
+  static char* secToTime(uint32_t sec, char* buffer, uint8_t bufferSize);
+
   /**
    * @brief Print the current runtime. 
+   * 
+   * Based on timeclock, so the runtime keeps counting past the 49.7-day millis() rollover.
+   * 
    * @return A character array representing the current runtime in HH:MM:SS format.
    */
   char* printRunTime() const {
-    return secToTime(millis() / 1000);
+    return secToTime(timeclock::seconds());
+  }
+
+  /**
+   * @brief Stream the current runtime to a Print (Serial, LCD, ...) as HH:MM:SS.
+   * @param out The destination.
+   * @return The number of characters written.
+   */
+  size_t printRunTime(Print& out) const {
+    return printTime(out, timeclock::seconds());
   }
 
   /**
@@ -108,12 +264,24 @@ public:
     return secToTime(sec);
   }
 
+  /**
+   * @brief Stream a time in seconds to a Print (Serial, LCD, ...) as HH:MM:SS or D:HH:MM:SS.
+   * @param out The destination.
+   * @param sec The time in seconds.
+   * @return The number of characters written.
+   */
+  static size_t printTime(Print& out, uint32_t sec);
+
   /**
    * @brief Convert milliseconds to seconds. 
+   * 
+   * Reads the incrementally maintained timeclock second counter, so it costs no division 
+   * and keeps counting past the 49.7-day millis() rollover.
+   * 
    * @return The time in seconds.
    */
   inline uint32_t millisToSeconds() const {
-    return millis() / 1000;
+    return timeclock::seconds();
   }
 
   /**
@@ -123,21 +291,26 @@ public:
    * @return The converted time value.
    */
   inline uint32_t convertTime(uint32_t time, TimeDirection direction) {
-    return (direction == MillisecondsToSeconds) ? (time / 1000) : (time * 1000);
+    return (direction == MillisecondsToSeconds) ? timeclock::toSeconds(time) : (time * 1000);
   }
 
   /**
    * @brief Reset the timer to its initial state without altering its running status or timelapse.
    * 
    * This function resets the reference times for both milliseconds and microseconds, 
-   * clears the event counter, and resets the last elapsed time record. It does not 
+   * clears the event counter, and resets the last elapsed time record, the history 
+   * and the running statistics. It does not 
    * affect the timer's state (_state) or configured timelapse (_timelapse).
    */
   inline void reset() {
+    beginWrite();
     pMillis = millis();
     _pMicros = micros();
     _count = 0;
     _lastElapsedTime = 0;
+    endWrite();
+    clearStats();
+    if (_scheduler) reschedule();
   }
 
   /**
@@ -162,6 +335,72 @@ public:
    */
   inline void setTimelapse(uint32_t timelapse) {
     _timelapse = timelapse;
+    _timelapseHigh = 0;
+    invalidateSeconds();
+    if (_scheduler) reschedule();
+  }
+
+  /**
+   * @brief Set a timelapse of 2^32 units or more (49.7 days in milliseconds, 71.6 minutes in microseconds).
+   * 
+   * elapsed() and elapsedMicros() keep their single 32-bit compare while the high word is 
+   * 0; with a high word the poll extends the reference to 64 bits through timeclock. The 
+   * timer must be polled less than 2^32 units after its reference was set by reset(), 
+   * resume() or an event, and timeclock has the same upkeep rule as millis64(). A 64-bit timelapse 
+   * restarts from the poll time (or the exact deadline in fixed-rate mode) and never counts 
+   * missed periods. elapsedSeconds() and timestate only use the low word.
+   * 
+   * @param timelapse The new timelapse in milliseconds (or microseconds for elapsedMicros).
+   */
+  inline void setTimelapse64(uint64_t timelapse) {
+    _timelapse = (uint32_t)timelapse;
+    _timelapseHigh = (uint32_t)(timelapse >> 32);
+    _longArmed = false;  // The next poll extends the current reference to 64 bits
+    invalidateSeconds();
+    if (_scheduler) reschedule();
+  }
+
+  /**
+   * @brief Get the timelapse including its high word (see setTimelapse64()).
+   * @return The timelapse in milliseconds (or microseconds for elapsedMicros).
+   */
+  inline uint64_t getTimelapse64() const {
+    return (((uint64_t)_timelapseHigh) << 32) | _timelapse;
+  }
+
+  /**
+   * @brief Get the remaining time until the next elapsed() event, without the 49.7-day limit.
+   * @return The remaining time in milliseconds, or 0 if stopped or elapsed.
+   */
+  inline uint64_t remainingTime64() const {
+    return remainingLong(millis(), false);
+  }
+
+  /**
+   * @brief Set how late the timer may fire so that a scheduler can batch it with others.
+   * 
+   * The timer becomes due at its timelapse as usual, but a timescheduler only has to 
+   * wake up for it once the slack has also passed. Whenever the scheduler fires a timer, 
+   * it also fires every timer with slack whose window is already open. With timers of 
+   * 100, 250, 500 and 1000 ms and a slack of a few tens of milliseconds, most 
+   * events then share a wakeup instead of each waking the MCU at its own phase. Firing 
+   * within the slack does not stretch the period: the next event is still due one 
+   * timelapse after the previous deadline, in fixed-delay mode too. Polling elapsed() 
+   * directly fires on time as before.
+   * 
+   * @param slack The tolerated lateness in milliseconds (0, the default, fires on time).
+   */
+  inline void setSlack(uint32_t slack) {
+    _slack = slack;
+    if (_scheduler) reschedule();
+  }
+
+  /**
+   * @brief Get the tolerated lateness used for batching in a scheduler.
+   * @return The slack in milliseconds.
+   */
+  inline uint32_t getSlack() const {
+    return _slack;
   }
 
   /**
@@ -181,17 +420,32 @@ public:
    * 
    * This function calculates how much time remains until the timelapse is reached, 
    * based on the current elapsed time. If the timer is stopped or the timelapse has 
-   * already elapsed, it returns 0.
+   * already elapsed, it returns 0. It only reads the timer: no callback is fired and 
+   * the count, state and references are left untouched.
    * 
    * @return The remaining time in milliseconds, or 0 if stopped or elapsed.
    */
-  uint32_t remainingTime();
+  inline uint32_t remainingTime() const {
+    return remainingTime(millis());
+  }
+
+  /**
+   * @brief Get the remaining time until the next elapsed event against a captured timestamp.
+   * @param now The current time in milliseconds.
+   * @return The remaining time in milliseconds, or 0 if stopped or elapsed.
+   */
+  inline uint32_t remainingTime(uint32_t now) const {
+    if (_timelapseHigh > 0) return clampRemaining(remainingLong(now, false));
+    uint32_t elapsedTime = now - pMillis;
+    return (_state && elapsedTime < _timelapse) ? (_timelapse - elapsedTime) : 0;
+  }
 
   /**
    * @brief Toggle the timer state between running and stopped.
    */
   inline void toggleState() {
     _state = !_state;
+    if (_scheduler) reschedule();
   }
 
   /**
@@ -228,6 +482,23 @@ public:
     _callback = callback;
   }
 
+  /**
+   * @brief Set a context-carrying callback, executed after the plain and elapsed callbacks.
+   * @param callback The delegate to execute (a function with its context, or a bound member).
+   */
+  inline void setCallback(timedelegate callback) {
+    _delegate = callback;
+  }
+
+  /**
+   * @brief Set a callback that receives a user context and the elapsed time.
+   * @param callback The function (or captureless lambda) to execute.
+   * @param context The pointer passed back to the callback.
+   */
+  inline void setCallback(timedelegate::function callback, void* context) {
+    _delegate = timedelegate(callback, context);
+  }
+
   /**
    * @brief Check if the timelapse has elapsed, using seconds instead of milliseconds.
    * @return True if the timelapse (in seconds) has elapsed, false otherwise.
@@ -242,8 +513,45 @@ public:
     resume();
   }
 
+  /**
+   * @brief Chain a stage that starts when this timer completes.
+   * 
+   * Completion is the last repetition of setRepeatCount() or runOnce(), or the end of a 
+   * countdown(). The next stage is then reset and started with its reference at the 
+   * completion time, so no callback has to restart it. Stages wait stopped (construct them 
+   * with state false, or stop() them): a stopped timer is not in the scheduler's deadline 
+   * heap and costs nothing per tick. Chains may loop back to an earlier stage.
+   * 
+   * @param next The timer to start on completion.
+   * @return The next stage, so that sequences read debounce.then(hold).then(pulse).
+   */
+  inline timecontrol& then(timecontrol& next) {
+    _next = &next;
+    return next;
+  }
+
+  /**
+   * @brief Set or clear the stage started when this timer completes.
+   * @param next The timer to start, or nullptr to end the chain here.
+   */
+  inline void setNext(timecontrol* next) {
+    _next = next;
+  }
+
+  /**
+   * @brief Get the stage started when this timer completes.
+   * @return The next stage, or nullptr.
+   */
+  inline timecontrol* getNext() const {
+    return _next;
+  }
+
   /**
    * @brief Set the number of times the timer should repeat before stopping.
+   * 
+   * When the last repetition fires the timer stops and, if it is registered with a 
+   * scheduler, leaves the scheduler's deadline heap until it is resumed.
+   * 
    * @param count Number of repetitions (0 for infinite).
    */
   inline void setRepeatCount(uint32_t count) {
@@ -258,6 +566,18 @@ public:
     return millis() - _startTime;
   }
 
+  /**
+   * @brief Get the total elapsed time without the 49.7-day rollover.
+   * 
+   * Requires timeclock::update() to run at least once per 49.7 days (timescheduler::tick() 
+   * does it).
+   * 
+   * @return Total elapsed time in milliseconds since creation, fullReset() or setStartTime().
+   */
+  inline uint64_t getTotalElapsedTime64() const {
+    return timeclock::millis64() - ((((uint64_t)_startHigh) << 32) | _startTime);
+  }
+
   /**
    * @brief Adjust the timelapse by adding or subtracting a value.
    * @param adjustment Amount to adjust (positive to increase, negative to decrease).
@@ -265,14 +585,22 @@ public:
   inline void adjustTimelapse(int32_t adjustment) {
     int32_t newTimelapse = (int32_t)_timelapse + adjustment;
     _timelapse = (newTimelapse > 0) ? newTimelapse : 0;
+    _timelapseHigh = 0;
+    invalidateSeconds();
+    if (_scheduler) reschedule();
   }
 
   /**
    * @brief Check if the timer is significantly overdue (exceeds timelapse by 2x).
+   * 
+   * Compares in two steps instead of against `_timelapse * 2`, which overflows for 
+   * timelapses above ~24.8 days. To supervise many tasks at once, see timewatchdog.
+   * 
    * @return True if overdue, false otherwise.
    */
   inline bool isOverdue() const {
-    return _state && (millis() - pMillis > _timelapse * 2);
+    uint32_t elapsed = millis() - pMillis;
+    return _state && elapsed > _timelapse && elapsed - _timelapse > _timelapse;
   }
 
   /**
@@ -281,6 +609,7 @@ public:
    */
   inline void setStartTime(uint32_t startTime) {
     _startTime = startTime;
+    _startHigh = timeclock::epochOf(startTime);
   }
 
   /**
@@ -295,16 +624,39 @@ public:
    */
   bool elapsedMicros();
 
+  /**
+   * @brief Check if the timelapse has elapsed in microseconds, against a captured timestamp.
+   * @param nowMicros The current time in microseconds.
+   * @return True if the timelapse (in microseconds) has elapsed, false otherwise.
+   */
+  bool elapsedMicros(uint32_t nowMicros);
+
+  /**
+   * @brief Get the remaining time until the next elapsedMicros() event.
+   * @param nowMicros The current time in microseconds.
+   * @return The remaining time in microseconds, or 0 if stopped or elapsed.
+   */
+  inline uint32_t remainingMicros(uint32_t nowMicros) const {
+    if (_timelapseHigh > 0) return clampRemaining(remainingLong(nowMicros, true));
+    uint32_t elapsedTime = nowMicros - _pMicros;
+    return (_state && elapsedTime < _timelapse) ? (_timelapse - elapsedTime) : 0;
+  }
+
   /**
    * @brief Fully reset the timer, including start time, to initial state.
    */
   inline void fullReset() {
     _startTime = millis();
+    _startHigh = timeclock::epochOf(_startTime);
+    beginWrite();
     pMillis = _startTime;
     _pMicros = micros();
     _count = 0;
     _lastElapsedTime = 0;
     _state = true;
+    endWrite();
+    clearStats();
+    if (_scheduler) reschedule();
   }
 
   /**
@@ -315,6 +667,51 @@ public:
     return _repeatCount;
   }
 
+  /**
+   * @brief Read the count, last elapsed time, reference and state as one consistent set.
+   * 
+   * On 8-bit targets a 32-bit field takes four stores, so reading elapsedCount() or 
+   * getLastElapsedTime() while an attached interrupt, the high-resolution backend or 
+   * another core fires the timer can return a torn value. Writers bump a sequence 
+   * counter around their few stores. The reader copies the fields and retries if 
+   * the counter was odd or changed in between. Interrupts are never disabled, and the 
+   * uncontended cost is one copy plus two byte compares. Call it from loop() or a task, 
+   * not from an interrupt handler: an ISR that spins on a write it interrupted would never 
+   * see it finish.
+   * 
+   * @return The copy.
+   */
+  timesnapshot snapshot() const;
+
+  /**
+   * @brief Save the timer's state to survive deep sleep or a reset.
+   * 
+   * Records the timelapse, running state, count, repetitions, fixed-rate settings, slack, 
+   * the elapsed history and statistics, and where the current period stands. Callbacks, 
+   * scheduler registration and interrupts are code, not state: set them up again in 
+   * setup() before calling restore().
+   * 
+   * @param out The state to fill (typically in RTC memory, or copied to EEPROM with EEPROM.put()).
+   */
+  void save(timestate& out) const;
+
+  /**
+   * @brief Restore a state written by save(), rebased by the time spent away.
+   * 
+   * The reference is moved back by the phase at the save plus sleptMicros, so the period 
+   * in progress ends exactly when it would have without the sleep: no restart from zero 
+   * and no warm-up cycle. A period that ended during the sleep is due immediately, and 
+   * fixed-rate timers apply their catch-up policy to the whole periods missed. The total 
+   * elapsed time keeps counting. Measure sleptMicros with the sleep timer you programmed or 
+   * the difference of two RTC readings.
+   * 
+   * @param in The saved state.
+   * @param sleptMicros Time between save() and this call that millis() did not count, in microseconds.
+   * @return True if the state was valid and has been applied, false (timer unchanged) 
+   * on a cold boot, a corrupted copy or a build with another TIMECONTROL_HISTORY_SIZE.
+   */
+  bool restore(const timestate& in, uint64_t sleptMicros = 0);
+
   /**
    * @brief Get the duration of the last elapsed event, in milliseconds.
    * 
@@ -336,13 +733,81 @@ public:
    * to the timer's interrupt handler. When the interrupt occurs, it executes the 
    * callback function set by setCallback() and updates the timer's state accordingly.
    * 
+   * Each interrupt number has its own slot in a static dispatch table, served by its own 
+   * trampoline, so any number of timers can use interrupts at the same time and the ISR 
+   * reaches its owning instance in O(1). Attaching a pin that is already owned by another 
+   * timer moves it to this one; a timer owns at most one pin.
+   * 
+   * In deferred mode the ISR only pushes the interrupt number and a millis() timestamp 
+   * into a lock-free single-producer/single-consumer ring; the callbacks and the event 
+   * bookkeeping then run from loop() when processInterrupts() (or a scheduler tick()) 
+   * drains the ring. This keeps interrupt latency low and makes it safe to use Serial 
+   * and other blocking code in the callbacks.
+   * 
    * @param pin The digital pin number to monitor for interrupts (must support interrupts on the board).
    * @param mode The interrupt mode (e.g., RISING, FALLING, CHANGE) that triggers the callback.
+   * @param deferred True to run the callbacks from loop() instead of interrupt context.
+   * @return True if the interrupt was attached, false if the pin has no interrupt or its 
+   * number exceeds TIMECONTROL_MAX_INTERRUPTS.
+   */
+  bool attachInterrupt(uint8_t pin, uint8_t mode, bool deferred = false);
+
+  /**
+   * @brief Count the edges of a pin in a timecounter, for frequency and RPM measurement.
+   * 
+   * The interrupt only increments the counter (and reads micros() in reciprocal mode), so 
+   * inputs of several kHz cost a few cycles per edge. This timer's period is the gate. 
+   * Each time it elapses, the edges of the gate are turned into a rate before the 
+   * callbacks run. Shares the dispatch table with attachInterrupt(): a timer owns one pin, 
+   * either for events or for counting.
+   * 
+   * @param counter The counter to feed (must outlive the attachment).
+   * @param pin The digital pin number (must support interrupts on the board).
+   * @param mode The edges to count (RISING, FALLING or CHANGE).
+   * @return True if the interrupt was attached, false if the pin has no interrupt or its 
+   * number exceeds TIMECONTROL_MAX_INTERRUPTS.
+   */
+  bool attachCounter(timecounter& counter, uint8_t pin, uint8_t mode);
+
+  /**
+   * @brief Detach the interrupt previously attached with attachInterrupt() or attachCounter().
+   */
+  void detachInterrupt();
+
+  /**
+   * @brief Run the callbacks of the interrupt events queued by deferred interrupts.
+   * 
+   * Call it from loop(); timescheduler::tick() calls it automatically. Events are 
+   * processed in arrival order, each with the timestamp recorded by the ISR.
+   * 
+   * @return The number of events processed.
+   */
+  static uint8_t processInterrupts();
+
+  /**
+   * @brief Get the number of interrupt events dropped because the deferred queue was full.
+   * 
+   * The counter is never reset; compare two readings to size TIMECONTROL_ISR_QUEUE_SIZE 
+   * for a given burst load.
+   * 
+   * @return The number of dropped events since startup.
+   */
+  static uint16_t getInterruptOverflows();
+
+  /**
+   * @brief Check if deferred interrupt events are waiting for processInterrupts().
+   * @return True if the deferred queue is not empty.
    */
-  void attachInterrupt(uint8_t pin, uint8_t mode);
+  static inline bool hasPendingInterrupts() {
+    return _isrHead != _isrTail;
+  }
 
   /**
    * @brief Wait for a specified duration without affecting the main timer.
+   * 
+   * Blocking, but the CPU idles between system ticks (see timeplatform::idle()) instead 
+   * of busy-waiting.
+   * 
    * @param 'duration' Duration to wait in milliseconds.
    */
   void wait(uint32_t duration);
@@ -392,14 +857,69 @@ public:
    * @brief Format the current elapsed time into a provided buffer as HH:MM:SS.
    * 
    * This function calculates the elapsed time since the last reset or event, converts 
-   * it into hours, minutes, and seconds, and formats it into a user-provided buffer 
-   * in the format "HH:MM:SS". The buffer must be large enough to hold the formatted 
-   * string (minimum 9 bytes including null terminator).
+   * it into days, hours, minutes, and seconds, and formats it into a user-provided buffer 
+   * in the format "HH:MM:SS" (or "D:HH:MM:SS" past one day), optionally followed by 
+   * ".mmm". The buffer must be large enough to hold the formatted string (minimum 9 bytes 
+   * including null terminator, 13 with milliseconds); longer text is truncated.
    * 
    * @param buffer Pointer to the character array where the formatted time will be stored.
    * @param bufferSize Size of the buffer in bytes, to prevent overflow.
+   * @param withMillis True to append the milliseconds.
+   */
+  void formatElapsedTime(char* buffer, uint8_t bufferSize, bool withMillis = false) const;
+
+  /**
+   * @brief Stream the current elapsed time to a Print as HH:MM:SS[.mmm].
+   * @param out The destination.
+   * @param withMillis True to append the milliseconds.
+   * @return The number of characters written.
+   */
+  size_t printElapsedTime(Print& out, bool withMillis = false) const;
+
+  /**
+   * @brief Select fixed-rate (drift-free) or fixed-delay (default) periodic mode.
+   * 
+   * In fixed-delay mode each event restarts the period from the time it was detected, so 
+   * every late poll shifts the phase. In fixed-rate mode the reference advances by exactly 
+   * one timelapse, keeping the events on the grid defined by the first reference, and the 
+   * policy decides what happens when whole periods were missed. getLastElapsedTime() and 
+   * the elapsed history then report one period plus the lateness of each event.
+   * 
+   * @param enable True for fixed-rate mode, false for fixed-delay mode.
+   * @param policy What to do with missed periods in fixed-rate mode.
+   */
+  inline void setFixedRate(bool enable, CatchUpPolicy policy = CatchUpFire) {
+    _fixedRate = enable;
+    _catchUp = policy;
+  }
+
+  /**
+   * @brief Check if the timer runs in fixed-rate mode.
+   * @return True if fixed-rate mode is enabled, false for fixed-delay.
+   */
+  inline bool isFixedRate() const {
+    return _fixedRate;
+  }
+
+  /**
+   * @brief Get the number of whole periods missed at the last event (fixed-rate mode).
+   * 
+   * With CatchUpFire it is the backlog still to be fired, with CatchUpSkip and 
+   * CatchUpCoalesce the number of slots that were skipped.
+   * 
+   * @return The number of missed periods, 0 if the last event was on time.
    */
-  void formatElapsedTime(char* buffer, uint8_t bufferSize) const;
+  inline uint32_t getMissedTicks() const {
+    return _missed;
+  }
+
+  /**
+   * @brief Set a callback that receives the number of coalesced ticks (CatchUpCoalesce policy).
+   * @param callback The function to execute with the missed count, after the other callbacks.
+   */
+  inline void setMissedCallback(void (*callback)(uint32_t)) {
+    _missedCallback = callback;
+  }
 
   /**
    * @brief Set the priority of callback execution.
@@ -409,16 +929,48 @@ public:
     _useElapsedFirst = useElapsedFirst;
   }
 
+#if TIMECONTROL_PROFILER
+  /**
+   * @brief Get the callback profile of this timer. Requires TIMECONTROL_PROFILER.
+   * @return The duration histogram, overruns and latency recorded so far.
+   */
+  inline const timeprofile& getProfile() const {
+    return _profile;
+  }
+
+  /**
+   * @brief Forget the samples recorded for this timer. Requires TIMECONTROL_PROFILER.
+   */
+  inline void clearProfile() {
+    _profile.clear();
+  }
+
+  /**
+   * @brief Write one profile line per instance, newest first. Requires TIMECONTROL_PROFILER.
+   * @param out The destination (Serial, ...).
+   * @return The number of characters written.
+   */
+  static size_t printProfiles(Print& out);
+#endif
+
   /**
    * @brief Pause all instances of timecontrol.
+   * 
+   * Walks the intrusive list of all constructed instances and stops each of them.
    */
   static void pauseAll();
 
   /**
    * @brief Resume the timer from an interrupt handler.
+   * 
+   * Safe to call in interrupt context: if the timer is registered with a scheduler, 
+   * the deadline heap is not touched here and the timer is re-armed on the next tick().
    */
   inline void resumeFromInterrupt() {
-    if (!_state) resume();
+    if (!_state) {
+      _state = true;
+      requestReschedule();
+    }
   }
 
   /**
@@ -430,12 +982,69 @@ public:
     return getTotalElapsedTime() >= timeout;
   }
 
+  /**
+   * @brief Check if total elapsed time exceeds a timeout longer than 49.7 days.
+   * @param timeout Timeout in milliseconds.
+   * @return True if time is up, false otherwise.
+   */
+  inline bool isTimeUp64(uint64_t timeout) const {
+    return getTotalElapsedTime64() >= timeout;
+  }
+
   /**
    * @brief Get the average elapsed time over a number of samples.
-   * @param samples Number of samples to average (max 10).
+   * 
+   * Averaging the whole history (samples >= TIMECONTROL_HISTORY_SIZE, or every event 
+   * recorded so far) uses the running window sum and costs O(1); a smaller window 
+   * sums the requested samples.
+   * 
+   * @param samples Number of samples to average (max TIMECONTROL_HISTORY_SIZE, 16 by default).
    * @return Average elapsed time in milliseconds.
    */
-  uint32_t getAverageElapsedTime(uint8_t samples);
+  uint32_t getAverageElapsedTime(uint8_t samples) const;
+
+  /**
+   * @brief Get the shortest elapsed event duration since the last reset.
+   * @return The minimum duration in milliseconds, or 0 if no event has occurred yet.
+   */
+  inline uint32_t getMinElapsedTime() const {
+    return (_count > 0) ? _minElapsed : 0;
+  }
+
+  /**
+   * @brief Get the longest elapsed event duration since the last reset.
+   * @return The maximum duration in milliseconds.
+   */
+  inline uint32_t getMaxElapsedTime() const {
+    return _maxElapsed;
+  }
+
+  /**
+   * @brief Get the mean elapsed event duration since the last reset (all events, not only the history).
+   * @return The running mean in milliseconds.
+   */
+  inline float getMeanElapsedTime() const {
+    return _meanElapsed;
+  }
+
+  /**
+   * @brief Get the variance of the elapsed event durations since the last reset.
+   * 
+   * Maintained in O(1) per event with Welford's algorithm.
+   * 
+   * @return The population variance in ms², or 0 with fewer than two events.
+   */
+  inline float getElapsedVariance() const {
+    return (_count > 1) ? _m2Elapsed / (float)_count : 0;
+  }
+
+  /**
+   * @brief Get the peak-to-peak jitter of the elapsed event durations since the last reset.
+   * @return The difference between the longest and shortest durations in milliseconds.
+   */
+  inline uint32_t getJitter() const {
+    return (_count > 0) ? _maxElapsed - _minElapsed : 0;
+  }
 
    /**
    * @brief Start or check a countdown with an optional callback when it reaches zero.
@@ -451,18 +1060,114 @@ private:
   uint32_t _count;                    /**< Counter for elapsed events. */
   bool _state;                        /**< The state of timecontrol (true for active, false for inactive). */
   uint32_t _startTime;                /**< Time of creation or full reset for total elapsed time. */
+  uint32_t _startHigh;                /**< timeclock wrap count of _startTime. */
   uint32_t _repeatCount;              /**< Number of repetitions (0 for infinite). */
   uint32_t _pMicros;                  /**< Previous micros value for microsecond timing. */
   uint32_t _lastElapsedTime;          /**< Time of the last elapsed event in milliseconds. */
   void (*_elapsedCallback)(uint32_t); /**< Callback with elapsed time parameter. */
   bool _useElapsedFirst;              /**< Priority of elapsed callback execution. */
-  uint32_t _elapsedTimes[10];         /**< Buffer for storing last elapsed times (max 10 samples). */
+  uint32_t _elapsedTimes[TIMECONTROL_HISTORY_SIZE]; /**< Buffer for storing last elapsed times. */
   uint8_t _elapsedIndex;              /**< Index for elapsed times buffer. */
+  uint32_t _historySum;               /**< Running sum of the elapsed times buffer. */
+  uint32_t _minElapsed;               /**< Shortest elapsed time since reset. */
+  uint32_t _maxElapsed;               /**< Longest elapsed time since reset. */
+  float _meanElapsed;                 /**< Running mean of elapsed times (Welford). */
+  float _m2Elapsed;                   /**< Running sum of squared deviations (Welford). */
   void (*_callback)(void);            /**< Callback function for elapsed events. */
+  timedelegate _delegate;             /**< Context-carrying callback, run after the other two. */
   static char _buffer[16];            /**< Static buffer for storing formatted time strings (optimized size for HH:MM:SS). */
+  timeschedulerbase* _scheduler;      /**< Scheduler this timer is registered with, or nullptr. */
+  uint32_t _deadline;                 /**< Latest firing time, heap key of the scheduler (pMillis + _timelapse + _slack). */
+  uint32_t _slack;                    /**< Tolerated lateness for batched firing in a scheduler. */
+  uint8_t _heapIndex;                 /**< Position in the scheduler's deadline heap (TIMESCHEDULER_NONE if not armed). */
+  volatile bool _rekeyPending;        /**< Set from interrupt context when the heap position must be refreshed. */
+  bool _windowed;                     /**< Counted by the scheduler as an armed timer with slack. */
+  bool _hires;                        /**< Registered with timehires (never with a scheduler at the same time). */
+
+  void reschedule();
+  void requestReschedule();
+
+  timecontrol* _nextInstance;         /**< Next instance in the list of all instances. */
+  uint8_t _interruptSlot;             /**< Interrupt number owned by this timer (TIMECONTROL_NO_INTERRUPT if none). */
+  bool _deferInterrupts;              /**< True to queue interrupt events for processInterrupts(). */
+  timecounter* _counter;              /**< Pulse counter fed by the interrupt (attachCounter()), or nullptr. */
+
+  /**
+   * @brief Entry of the deferred interrupt queue.
+   */
+  struct interruptevent {
+    uint8_t slot;   /**< Interrupt number that fired. */
+    uint32_t time;  /**< millis() value when it fired. */
+  };
+
+  typedef void (*isrfunc)(void);
+  static timecontrol* _firstInstance;                                    /**< Head of the list of all instances. */
+  static timecontrol* volatile _isrInstances[TIMECONTROL_MAX_INTERRUPTS]; /**< Owner of each interrupt number. */
+  static interruptevent _isrQueue[TIMECONTROL_ISR_QUEUE_SIZE];           /**< Deferred interrupt ring. */
+  static volatile uint8_t _isrHead;                                      /**< Next write position (ISR side, free running). */
+  static volatile uint8_t _isrTail;                                      /**< Next read position (loop side, free running). */
+  static volatile uint16_t _isrOverflows;                                /**< Events dropped on a full ring. */
+
+  bool _fixedRate;                    /**< True for fixed-rate (drift-free) mode. */
+  uint8_t _catchUp;                   /**< CatchUpPolicy applied in fixed-rate mode. */
+  uint32_t _missed;                   /**< Whole periods missed at the last event. */
+  void (*_missedCallback)(uint32_t);  /**< Callback receiving the missed count (CatchUpCoalesce). */
+  uint32_t _secLapse;                 /**< Milliseconds from _secReference to the elapsedSeconds() target. */
+  uint32_t _secReference;             /**< Reference _secLapse was computed for. */
+  timecontrol* _next;                 /**< Stage started when this timer completes, or nullptr. */
+  volatile uint8_t _sequence;         /**< Seqlock counter for snapshot(), odd while the event fields change. */
+#if TIMECONTROL_PROFILER
+  timeprofile _profile;               /**< Callback durations, overruns and latency. */
+#endif
+  uint32_t _timelapseHigh;            /**< High word of a setTimelapse64() timelapse, 0 for 32-bit ones. */
+  uint32_t _longReference;            /**< Reference _referenceHigh was computed for. */
+  uint32_t _referenceHigh;            /**< High word of the 64-bit reference of a long timelapse. */
+  bool _longArmed;                    /**< _referenceHigh is valid for _longReference. */
+
+  uint32_t nextReference(uint32_t reference, uint32_t current);
+  template <TimeBase Base> bool poll(uint32_t current, bool inInterrupt = false);
+  bool elapsedMicrosFromInterrupt(uint32_t current);  // timehires interrupt entry: heap changes are deferred to tick()
+  void armSeconds();
+  bool dueLong(uint32_t reference, uint32_t current, bool inMicros, uint32_t& elapsedTime);
+  uint64_t remainingLong(uint32_t now, bool inMicros) const;
+  static inline uint64_t widen(uint64_t clock, uint32_t value) {
+    return clock + (int64_t)(int32_t)(value - (uint32_t)clock);  // The 64-bit value nearest to clock
+  }
+  static inline uint64_t extendReference(uint64_t now, uint32_t reference) {
+    uint32_t ahead = reference - (uint32_t)now;  // Set by a callback of the same pass: slightly ahead
+    return (ahead < 0x01000000) ? now + ahead : now - (uint32_t)((uint32_t)now - reference);
+  }
+  static inline uint32_t clampRemaining(uint64_t remaining) {
+    return (remaining > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)remaining;
+  }
+  void startNext(uint32_t now, bool inInterrupt);
+  inline void invalidateSeconds() {
+    _secReference = ~pMillis;  // Never equal to pMillis: the next elapsedSeconds() re-arms
+  }
+  inline void beginWrite() {
+    _sequence++;
+    TIMECONTROL_BARRIER();  // Odd count visible before the fields change
+  }
+  inline void endWrite() {
+    TIMECONTROL_BARRIER();  // Fields written before the count is even again
+    _sequence++;
+  }
+  void fire(uint32_t elapsedTime);
+  static uint16_t checksum(const timestate& state);
+  static uint8_t formatDuration(char* out, uint32_t sec, uint16_t milliseconds, bool withMillis);
+  static char* copyText(char* buffer, uint8_t bufferSize, const char* text, uint8_t length);
+  void recordElapsed(uint32_t elapsedTime);
+  void clearStats();
+  void link();
+  void unlink();
+  bool attachSlot(uint8_t pin, uint8_t mode, bool deferred, timecounter* counter);
+  void handleInterruptEvent(uint32_t time, bool inInterrupt);
+  static void interruptHandler(timecontrol* instance);
+  template <uint8_t Slot> static void interruptTrampoline();
+  template <uint8_t Slot> static isrfunc trampolineFor(uint8_t slot);
 
-  static void interruptHandler();
-  static timecontrol* _instance;
+  friend class timeschedulerbase;
+  friend class timehires;
 };
 
 #endif  // TIMECONTROL_H
@@ -0,0 +1,57 @@
+/**
+ * @file timecounter.cpp
+ * @brief Edge counting and gate/reciprocal rate computation for timecontrol::attachCounter().
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timecounter.h"
+#include "timeplatform.h"
+
+timecounter::timecounter(bool reciprocal)
+  : _reciprocal(reciprocal) {
+  reset();
+}
+
+uint32_t timecounter::getTotal() const {
+  timecriticalsection lock;  // Four stores on 8-bit targets
+  return _total;
+}
+
+float timecounter::getFrequency() const {
+  if (_span > 0) return (float)_count * 1000000.0f / (float)_span;
+  return (_gate > 0) ? (float)_count * 1000.0f / (float)_gate : 0;
+}
+
+void timecounter::reset() {
+  timecriticalsection lock;
+  _total = 0;
+  _edge = 0;
+  _latchedTotal = 0;
+  _latchedEdge = 0;
+  _count = 0;
+  _gate = 0;
+  _lastLatch = millis();
+  _span = 0;
+  _primed = false;
+}
+
+void timecounter::latch(uint32_t now) {
+  uint32_t total, edge;
+  {
+    timecriticalsection lock;  // Count and timestamp of the same edge
+    total = _total;
+    edge = _edge;
+  }
+  _count = total - _latchedTotal;
+  _latchedTotal = total;
+  _gate = now - _lastLatch;  // What the edges were counted over, whatever moved the timer's reference
+  _lastLatch = now;
+  _span = 0;
+  if (!_reciprocal || _count == 0) return;
+  if (_primed) _span = edge - _latchedEdge;  // _count intervals end at this gate's last edge
+  _latchedEdge = edge;
+  _primed = true;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file timecounter.h
+ * @brief Header file for the timecounter class.
+ * This file declares the pulse counter fed by timecontrol::attachCounter(): the ISR only 
+ * counts edges, and each period of the owning timer turns the count into a frequency.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMECOUNTER_H
+#define TIMECOUNTER_H
+
+#include "timecontrol.h"
+
+/**
+ * @brief Edge counter for tachometers, flow meters and other pulse inputs.
+ * 
+ * Attached with timecontrol::attachCounter(), the interrupt does nothing but increment a 
+ * counter: no millis() read, no history, no callback, no wake-up. The timer's period is the 
+ * gate. Each time it elapses (polled or in a scheduler), the edges of the gate are latched 
+ * before the timer's callbacks run, so they can read the new rate.
+ * 
+ * | Mode | ISR cost | Result |
+ * | --- | --- | --- |
+ * | Gate (default) | One increment | Edges / gate time: resolution of one edge per gate, best at high rates |
+ * | Reciprocal | Increment and one micros() read | Edges / time between the last edges of two gates: microsecond resolution, best at low rates |
+ * 
+ * Reciprocal gates follow each other without dead time: each gate measures from the last 
+ * edge of the previous one. The first gate of a reciprocal counter, and any gate without an 
+ * edge, use the gate formula.
+ */
+class timecounter {
+public:
+  /**
+   * @brief Construct a counter.
+   * @param reciprocal True to timestamp edges and compute the rate from their spacing.
+   */
+  timecounter(bool reciprocal = false);
+
+  /**
+   * @brief Get the edges counted during the last gate.
+   * @return The number of edges.
+   */
+  inline uint32_t getCount() const {
+    return _count;
+  }
+
+  /**
+   * @brief Get the edges counted since construction or reset(), including the open gate.
+   * @return The number of edges.
+   */
+  uint32_t getTotal() const;
+
+  /**
+   * @brief Get the length of the last gate.
+   * 
+   * Measured between two latches, not taken from the timer's elapsed time: in fixed-rate 
+   * mode or within the slack the reference advances by the timelapse, so a late event 
+   * followed by an on-time one would otherwise count the lateness twice.
+   * 
+   * @return The time between the last two latches in milliseconds.
+   */
+  inline uint32_t getGateTime() const {
+    return _gate;
+  }
+
+  /**
+   * @brief Get the input frequency measured over the last gate.
+   * @return The frequency in Hz, 0 before the first gate.
+   */
+  float getFrequency() const;
+
+  /**
+   * @brief Get the rotation speed measured over the last gate.
+   * @param pulsesPerRevolution Edges per revolution of the sensor (tachometer teeth, magnets...).
+   * @return The speed in revolutions per minute.
+   */
+  inline float getRPM(uint16_t pulsesPerRevolution = 1) const {
+    return getFrequency() * 60.0f / (float)pulsesPerRevolution;
+  }
+
+  /**
+   * @brief Check if the counter timestamps edges (reciprocal mode).
+   * @return True in reciprocal mode.
+   */
+  inline bool isReciprocal() const {
+    return _reciprocal;
+  }
+
+  /**
+   * @brief Forget all edges and results.
+   */
+  void reset();
+
+private:
+  volatile uint32_t _total;  /**< Edges since reset, written by the ISR. */
+  volatile uint32_t _edge;   /**< micros() of the last edge (reciprocal mode), written by the ISR. */
+  uint32_t _latchedTotal;    /**< _total at the last gate. */
+  uint32_t _latchedEdge;     /**< _edge at the last gate that had an edge. */
+  uint32_t _count;           /**< Edges in the last gate. */
+  uint32_t _gate;            /**< Last gate time in milliseconds. */
+  uint32_t _lastLatch;       /**< millis() at the last latch, attach or reset(): start of the open gate. */
+  uint32_t _span;            /**< Microseconds covered by the last gate's edges (reciprocal), 0 if unknown. */
+  bool _reciprocal;          /**< True to timestamp edges. */
+  bool _primed;              /**< True once _latchedEdge holds an edge time. */
+
+  /**
+   * @brief Count one edge. Called from the interrupt trampoline.
+   */
+  inline void count() {
+    if (_reciprocal) _edge = micros();
+    _total++;
+  }
+
+  void latch(uint32_t now);
+
+  friend class timecontrol;
+};
+
+#endif  // TIMECOUNTER_H
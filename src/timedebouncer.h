@@ -0,0 +1,193 @@
+/**
+ * @file timedebouncer.h
+ * @brief Header file for the timedebouncer class template.
+ * This file declares a debouncer for up to 8, 16 or 32 inputs that shares a single 
+ * timecontrol tick and debounces all of them with a vertical counter.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEDEBOUNCER_H
+#define TIMEDEBOUNCER_H
+
+#include "timecontrol.h"
+
+const uint8_t TIMEDEBOUNCER_NO_PIN = 0xFF; /**< Pin of an input fed through process() only. */
+
+/**
+ * @brief Debouncer for many inputs driven by one timer.
+ * 
+ * Each input is one bit of Bits (uint8_t, uint16_t or uint32_t). Two bit planes form a 
+ * 2-bit counter per input ("vertical counter"), so all inputs are debounced together in 
+ * a handful of bitwise operations per tick, whatever their number. An input changes state 
+ * once it has read the same level for four consecutive ticks: 20 ms with the default 5 ms 
+ * tick. Edge callbacks receive the input id (its bit number) and the new state.
+ * 
+ * The tick is an ordinary timecontrol: call update() from loop(), or register getTimer() 
+ * with a timescheduler. Inputs attached to pins are read with digitalRead() on each tick; 
+ * inputs behind a port register or a shift register can be fed to process() as one word 
+ * instead.
+ * 
+ * @tparam Bits Unsigned type with one bit per input.
+ */
+template <class Bits = uint8_t>
+class timedebouncer {
+  static_assert((Bits)~(Bits)0 > 0, "timedebouncer Bits must be an unsigned type");
+
+public:
+  typedef void (*edgecallback)(uint8_t id, bool pressed);  /**< Edge callback signature. */
+
+  static const uint8_t INPUTS = sizeof(Bits) * 8;  /**< Number of inputs. */
+
+  /**
+   * @brief Construct a debouncer.
+   * @param interval The sampling tick in milliseconds (inputs settle after four ticks).
+   */
+  timedebouncer(uint32_t interval = 5)
+    : _timer(interval), _state(0), _count0((Bits)~(Bits)0), _count1((Bits)~(Bits)0), _changed(0), 
+      _used(0), _activeLow(0), _callback(nullptr) {  // Counters start at their reload value (3)
+    for (uint8_t i = 0; i < INPUTS; i++) _pins[i] = TIMEDEBOUNCER_NO_PIN;
+    _timer.setCallback(timedelegate::bind<timedebouncer, &timedebouncer::sample>(*this));
+  }
+
+  timedebouncer(const timedebouncer&) = delete;             /**< Not copyable: the tick timer is bound to this object. */
+  timedebouncer& operator=(const timedebouncer&) = delete;  /**< Not assignable. */
+
+  /**
+   * @brief Attach an input pin to an id.
+   * @param id The input id (bit number, 0 to INPUTS - 1).
+   * @param pin The digital pin to read.
+   * @param activeLow True for buttons to ground with a pull-up (reads LOW when pressed).
+   * @return True if attached, false if the id is out of range.
+   */
+  bool attach(uint8_t id, uint8_t pin, bool activeLow = true) {
+    if (id >= INPUTS) return false;
+    Bits bit = (Bits)1 << id;
+    pinMode(pin, activeLow ? INPUT_PULLUP : INPUT);
+    _pins[id] = pin;
+    _used |= bit;
+    _activeLow = activeLow ? (_activeLow | bit) : (_activeLow & ~bit);
+    return true;
+  }
+
+  /**
+   * @brief Set the callback executed for every debounced edge.
+   * @param callback Function receiving the input id and true when pressed, false when released.
+   */
+  inline void setCallback(edgecallback callback) {
+    _callback = callback;
+  }
+
+  /**
+   * @brief Sample the attached pins if the tick has elapsed.
+   * @return True if a tick ran.
+   */
+  inline bool update() {
+    return _timer.elapsed();
+  }
+
+  /**
+   * @brief Debounce one raw sample of all inputs and run the edge callbacks.
+   * 
+   * Called by each tick with the attached pins; call it directly (at a steady rate) to feed 
+   * inputs read in one go, as a port register or a shift register. Bit i is input i, 1 
+   * meaning pressed.
+   * 
+   * @param raw The raw input levels.
+   * @return The inputs whose debounced state changed.
+   */
+  Bits process(Bits raw) {
+    Bits delta = raw ^ _state;              // Inputs that differ from their debounced state
+    _count0 = ~(_count0 & delta);           // Counters of stable inputs reset to 3,
+    _count1 = _count0 ^ (_count1 & delta);  // the others count down
+    _changed = delta & _count0 & _count1;   // Rolled over: four samples in a row
+    _state ^= _changed;
+    if (_changed && _callback) {
+      Bits pending = _changed;
+      for (uint8_t id = 0; pending; id++, pending >>= 1) {
+        if (pending & 1) _callback(id, (_state >> id) & 1);
+      }
+    }
+    return _changed;
+  }
+
+  /**
+   * @brief Check the debounced state of an input.
+   * @param id The input id.
+   * @return True if pressed.
+   */
+  inline bool isPressed(uint8_t id) const {
+    return (id < INPUTS) && ((_state >> id) & 1);
+  }
+
+  /**
+   * @brief Get the debounced state of all inputs.
+   * @return One bit per input, 1 for pressed.
+   */
+  inline Bits getState() const {
+    return _state;
+  }
+
+  /**
+   * @brief Get the inputs that changed state during the last tick.
+   * @return One bit per input.
+   */
+  inline Bits getChanged() const {
+    return _changed;
+  }
+
+  /**
+   * @brief Get the inputs pressed during the last tick.
+   * @return One bit per input.
+   */
+  inline Bits getPressed() const {
+    return _changed & _state;
+  }
+
+  /**
+   * @brief Get the inputs released during the last tick.
+   * @return One bit per input.
+   */
+  inline Bits getReleased() const {
+    return _changed & ~_state;
+  }
+
+  /**
+   * @brief Get the tick timer, to register it with a timescheduler or change its interval.
+   * @return The timer that samples the pins.
+   */
+  inline timecontrol& getTimer() {
+    return _timer;
+  }
+
+private:
+  timecontrol _timer;       /**< Sampling tick. */
+  Bits _state;              /**< Debounced states. */
+  Bits _count0;             /**< Low bit plane of the per-input counters. */
+  Bits _count1;             /**< High bit plane of the per-input counters. */
+  Bits _changed;            /**< Inputs that changed at the last tick. */
+  Bits _used;               /**< Inputs attached to a pin. */
+  Bits _activeLow;          /**< Attached inputs that read LOW when pressed. */
+  edgecallback _callback;   /**< Edge callback, or nullptr. */
+  uint8_t _pins[INPUTS];    /**< Pin of each input, TIMEDEBOUNCER_NO_PIN if not attached. */
+
+  /**
+   * @brief Read the attached pins and debounce them. Bound to the tick timer.
+   */
+  void sample() {
+    Bits raw = 0;
+    Bits pending = _used;
+    for (uint8_t id = 0; pending; id++, pending >>= 1) {
+      if ((pending & 1) && digitalRead(_pins[id])) raw |= (Bits)1 << id;
+    }
+    process(raw ^ _activeLow);
+  }
+};
+
+typedef timedebouncer<uint8_t> timedebouncer8;    /**< Up to 8 inputs. */
+typedef timedebouncer<uint16_t> timedebouncer16;  /**< Up to 16 inputs. */
+typedef timedebouncer<uint32_t> timedebouncer32;  /**< Up to 32 inputs. */
+
+#endif  // TIMEDEBOUNCER_H
@@ -0,0 +1,110 @@
+/**
+ * @file timedelegate.h
+ * @brief Header file for the timedelegate class.
+ * This file declares the context-carrying callback used by timecontrol: a function 
+ * pointer plus a void* payload, with helpers to bind member functions.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEDELEGATE_H
+#define TIMEDELEGATE_H
+
+#include "timearduino.h"
+
+/**
+ * @brief Callback that carries a context pointer, without heap allocation.
+ * 
+ * Holds a `void (*)(void* context, uint32_t elapsedTime)` and its context: two pointers, 
+ * invoked with a single indirect call. One function can then serve many timers (one per 
+ * channel, object or pin) instead of writing a free function and a global for each.
+ * 
+ * | Target | How to build it |
+ * | --- | --- |
+ * | Function taking the context | `timedelegate(function, &context)` |
+ * | Captureless lambda | `timedelegate([](void* context, uint32_t elapsedTime) { ... }, &context)` |
+ * | Member `void T::f(uint32_t)` | `timedelegate::bind<T, &T::f>(object)` |
+ * | Member `void T::f()` | `timedelegate::bind<T, &T::f>(object)` |
+ * 
+ * Member binding generates a small trampoline at compile time; the call to the member 
+ * is direct and usually inlined into it. The bound object must outlive the delegate.
+ */
+class timedelegate {
+public:
+  typedef void (*function)(void* context, uint32_t elapsedTime);  /**< Target signature. */
+
+  /**
+   * @brief Construct an empty delegate. Invoking it does nothing.
+   */
+  constexpr timedelegate() : _function(nullptr), _context(nullptr) {}
+
+  /**
+   * @brief Construct a delegate from a function (or captureless lambda) and its context.
+   * @param target The function to call.
+   * @param context The pointer passed back to it on each call.
+   */
+  constexpr timedelegate(function target, void* context = nullptr)
+    : _function(target), _context(context) {}
+
+  /**
+   * @brief Bind a member function that receives the elapsed time.
+   * @param object The object the member is called on.
+   * @return The delegate.
+   */
+  template <class T, void (T::*Method)(uint32_t)>
+  static inline timedelegate bind(T& object) {
+    return timedelegate(&memberTrampoline<T, Method>, &object);
+  }
+
+  /**
+   * @brief Bind a member function without parameters.
+   * @param object The object the member is called on.
+   * @return The delegate.
+   */
+  template <class T, void (T::*Method)()>
+  static inline timedelegate bind(T& object) {
+    return timedelegate(&memberTrampoline<T, Method>, &object);
+  }
+
+  /**
+   * @brief Call the target, if any.
+   * @param elapsedTime The elapsed time passed to the target.
+   */
+  inline void operator()(uint32_t elapsedTime) const {
+    if (_function) _function(_context, elapsedTime);
+  }
+
+  /**
+   * @brief Check whether a target is set.
+   * @return True if the delegate calls something.
+   */
+  inline explicit operator bool() const {
+    return _function != nullptr;
+  }
+
+  /**
+   * @brief Get the context pointer.
+   * @return The context passed to the target.
+   */
+  inline void* getContext() const {
+    return _context;
+  }
+
+private:
+  function _function;  /**< Target, or nullptr. */
+  void* _context;      /**< Payload passed to the target. */
+
+  template <class T, void (T::*Method)(uint32_t)>
+  static void memberTrampoline(void* context, uint32_t elapsedTime) {
+    (static_cast<T*>(context)->*Method)(elapsedTime);
+  }
+
+  template <class T, void (T::*Method)()>
+  static void memberTrampoline(void* context, uint32_t) {
+    (static_cast<T*>(context)->*Method)();
+  }
+};
+
+#endif  // TIMEDELEGATE_H
@@ -0,0 +1,217 @@
+/**
+ * @file timehires.cpp
+ * @brief Hardware compare-match backend for microsecond timers: AVR Timer1, ESP32
+ * esp_timer and SAMD21 TC3, with a polled fallback for other boards.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timehires.h"
+#include "timeplatform.h"
+
+#if defined(__AVR__) && TIMEHIRES_HARDWARE
+#include <avr/interrupt.h>
+#if F_CPU >= 8000000L
+const uint8_t TIMEHIRES_PRESCALER = _BV(CS11);                  // clk/8
+const uint32_t TIMEHIRES_TICKS_PER_US = F_CPU / 8000000L;
+#else
+const uint8_t TIMEHIRES_PRESCALER = _BV(CS10);                  // clk/1
+const uint32_t TIMEHIRES_TICKS_PER_US = F_CPU / 1000000L;
+#endif
+const uint16_t TIMEHIRES_MIN_TICKS = 8;      // Covers the read-add-write of OCR1A
+const uint16_t TIMEHIRES_MAX_TICKS = 60000;  // Longer delays re-arm on intermediate matches
+#elif defined(ARDUINO_ARCH_SAMD) && TIMEHIRES_HARDWARE
+const uint32_t TIMEHIRES_TICKS_PER_US = F_CPU / 16000000L;      // GCLK0 / 16
+const uint16_t TIMEHIRES_MIN_TICKS = 32;     // Covers the register synchronization
+const uint16_t TIMEHIRES_MAX_TICKS = 60000;
+#endif
+
+timecontrol* timehires::_timers[TIMEHIRES_MAX_TIMERS] = {};
+volatile uint8_t timehires::_size = 0;
+bool timehires::_running = false;
+#if defined(ESP32)
+esp_timer_handle_t timehires::_handle = nullptr;
+#endif
+
+#if defined(__AVR__) && TIMEHIRES_HARDWARE
+
+ISR(TIMER1_COMPA_vect) {
+  timehires::serviceInterrupt();
+}
+
+#elif defined(ARDUINO_ARCH_SAMD) && TIMEHIRES_HARDWARE
+
+extern "C" void TC3_Handler() {
+  TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+  timehires::serviceInterrupt();
+}
+
+#elif defined(ESP32)
+
+void timehires::onTimer(void*) {
+  serviceInterrupt();
+}
+
+#endif
+
+bool timehires::begin() {
+#if TIMEHIRES_HARDWARE
+  if (_running) return true;
+#if defined(__AVR__)
+  {
+    timecriticalsection lock;
+    TCCR1A = 0;                     // Normal mode: Timer1 free-runs, OCR1A is moved ahead
+    TCCR1B = TIMEHIRES_PRESCALER;
+    TIMSK1 = 0;
+  }
+#elif defined(ESP32)
+  if (!_handle) {
+    esp_timer_create_args_t args = {};
+    args.callback = &timehires::onTimer;
+    args.name = "timehires";
+    if (esp_timer_create(&args, &_handle) != ESP_OK) return false;
+  }
+#elif defined(ARDUINO_ARCH_SAMD)
+  PM->APBCMASK.reg |= PM_APBCMASK_TC3;
+  GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TCC2_TC3);
+  while (GCLK->STATUS.bit.SYNCBUSY);
+  TC3->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  while (TC3->COUNT16.CTRLA.bit.SWRST);
+  TC3->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV16;
+  TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MC0;
+  TC3->COUNT16.CTRLA.bit.ENABLE = 1;
+  while (TC3->COUNT16.STATUS.bit.SYNCBUSY);
+  NVIC_ClearPendingIRQ(TC3_IRQn);
+  NVIC_EnableIRQ(TC3_IRQn);
+#endif
+  _running = true;
+  update();
+  return true;
+#else
+  return false;
+#endif
+}
+
+void timehires::end() {
+  if (!_running) return;
+  _running = false;
+  disarm();
+}
+
+bool timehires::add(timecontrol& timer) {
+  if (timer._scheduler) return false;
+  {
+    timecriticalsection lock;
+    if (_size >= TIMEHIRES_MAX_TIMERS) return false;
+    for (uint8_t i = 0; i < _size; i++) {
+      if (_timers[i] == &timer) return false;
+    }
+    _timers[_size] = &timer;
+    _size = _size + 1;
+    timer._hires = true;  // timescheduler::add() refuses it from now on
+  }
+  update();
+  return true;
+}
+
+bool timehires::remove(timecontrol& timer) {
+  {
+    timecriticalsection lock;
+    uint8_t i = 0;
+    while (i < _size && _timers[i] != &timer) i++;
+    if (i == _size) return false;
+    _size = _size - 1;
+    _timers[i] = _timers[_size];
+    _timers[_size] = nullptr;
+    timer._hires = false;
+  }
+  update();
+  return true;
+}
+
+void timehires::update() {
+  if (!_running) return;
+#if defined(ESP32)
+  arm(nextDelay());                 // esp_timer serializes its own calls
+#else
+  timecriticalsection lock;
+  arm(nextDelay());
+#endif
+}
+
+void timehires::poll() {
+  if (!_running) fireDue(false);
+}
+
+void timehires::serviceInterrupt() {
+  fireDue(true);
+  if (_running) arm(nextDelay());
+}
+
+void timehires::fireDue(bool inInterrupt) {
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < _size; i++) {
+    timecontrol* timer = _timers[i];
+    if (!timer) continue;
+    if (inInterrupt) {
+      timer->elapsedMicrosFromInterrupt(now);  // Chained stages in a scheduler are re-keyed by its next tick()
+    } else {
+      timer->elapsedMicros(now);
+    }
+  }
+}
+
+uint32_t timehires::nextDelay() {
+  uint32_t now = micros();  // Read after the callbacks, which may have taken a while
+  uint32_t next = TIMEHIRES_NO_DEADLINE;
+  for (uint8_t i = 0; i < _size; i++) {
+    timecontrol* timer = _timers[i];
+    if (timer && timer->isRunning()) {
+      uint32_t remaining = timer->remainingMicros(now);
+      if (remaining < next) next = remaining;
+    }
+  }
+  return next;
+}
+
+// Called with interrupts disabled (update()) or from the handler itself.
+void timehires::arm(uint32_t delay) {
+  if (delay == TIMEHIRES_NO_DEADLINE) {
+    disarm();
+    return;
+  }
+#if defined(ESP32)
+  esp_timer_stop(_handle);
+  esp_timer_start_once(_handle, delay > 0 ? delay : 1);
+#elif TIMEHIRES_HARDWARE
+  uint32_t ticks = (delay < TIMEHIRES_MAX_TICKS) ? delay * TIMEHIRES_TICKS_PER_US : TIMEHIRES_MAX_TICKS;
+  if (ticks < TIMEHIRES_MIN_TICKS) ticks = TIMEHIRES_MIN_TICKS;
+  if (ticks > TIMEHIRES_MAX_TICKS) ticks = TIMEHIRES_MAX_TICKS;
+#if defined(__AVR__)
+  OCR1A = TCNT1 + (uint16_t)ticks;
+  TIFR1 = _BV(OCF1A);               // Drop a stale match before enabling
+  TIMSK1 |= _BV(OCIE1A);
+#elif defined(ARDUINO_ARCH_SAMD)
+  TC3->COUNT16.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(0x10);  // COUNT
+  while (TC3->COUNT16.STATUS.bit.SYNCBUSY);
+  TC3->COUNT16.CC[0].reg = (uint16_t)(TC3->COUNT16.COUNT.reg + ticks);
+  while (TC3->COUNT16.STATUS.bit.SYNCBUSY);
+  TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+  TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+#endif
+#else
+  (void)delay;
+#endif
+}
+
+void timehires::disarm() {
+#if defined(__AVR__) && TIMEHIRES_HARDWARE
+  TIMSK1 &= ~_BV(OCIE1A);
+#elif defined(ESP32)
+  if (_handle) esp_timer_stop(_handle);
+#elif defined(ARDUINO_ARCH_SAMD) && TIMEHIRES_HARDWARE
+  TC3->COUNT16.INTENCLR.reg = TC_INTENCLR_MC0;
+#endif
+}
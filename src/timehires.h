@@ -0,0 +1,149 @@
+/**
+ * @file timehires.h
+ * @brief Header file for the timehires class.
+ * This file declares the hardware compare-match backend that fires microsecond 
+ * timecontrol timers without relying on loop() polling.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEHIRES_H
+#define TIMEHIRES_H
+
+#include "timearduino.h"
+#include "timecontrol.h"
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#endif
+
+/**
+ * @brief Maximum number of timers driven by the high-resolution backend.
+ * 
+ * Every interrupt scans all of them, so keep it small. Set it as a build flag, so that the 
+ * library sources see it: a #define in the sketch does not reach timehires.cpp.
+ */
+#ifndef TIMEHIRES_MAX_TIMERS
+#define TIMEHIRES_MAX_TIMERS 4
+#endif
+
+/**
+ * @brief 1 when a hardware compare-match backend exists for this board, 0 otherwise.
+ */
+#if (defined(__AVR__) && defined(OCR1A)) || defined(ESP32) || \
+    (defined(ARDUINO_ARCH_SAMD) && !defined(__SAMD51__))
+#define TIMEHIRES_HARDWARE 1
+#else
+#define TIMEHIRES_HARDWARE 0
+#endif
+
+const uint32_t TIMEHIRES_NO_DEADLINE = 0xFFFFFFFF;  /**< No running timer: nothing to arm. */
+
+/**
+ * @brief Fires microsecond timers from a hardware timer interrupt.
+ * 
+ * Registered timers use their timelapse in microseconds (as elapsedMicros()). After each 
+ * event, the compare match is armed for the earliest deadline, so callbacks run within 
+ * a few microseconds of it however long loop() blocks. The usual _callback and 
+ * _elapsedCallback plumbing, repeat count and fixed-rate policies apply.
+ * 
+ * | Platform | Hardware | Resolution | Callbacks run in |
+ * | --- | --- | --- | --- |
+ * | AVR | Timer1 compare A (`TIMER1_COMPA_vect`) | 0.5 us (16 MHz) | Interrupt |
+ * | ESP32 | One-shot `esp_timer` | 1 us (tens of us dispatch latency) | esp_timer task |
+ * | SAMD21 | TC3 compare channel 0 (`TC3_Handler`) | 0.33 us | Interrupt |
+ * | Others | None: poll() from loop() | Loop period | loop() |
+ * 
+ * Callbacks that run in interrupt context must be short and may only touch volatile 
+ * state. A timer is either in timehires or in a timescheduler, never both: each add() 
+ * refuses timers owned by the other. Stages chained with then() may live in a scheduler; 
+ * when a stage finishes inside the interrupt, the next one is only flagged and the 
+ * scheduler re-keys it on its next tick(). remove() a timer before destroying it.
+ */
+class timehires {
+public:
+  /**
+   * @brief Take over the hardware timer and start firing the registered timers.
+   * 
+   * On AVR this reconfigures Timer1 and on SAMD21 TC3, so it conflicts with libraries 
+   * that use them (Servo, TimerOne, ...).
+   * 
+   * @return True if a hardware backend is running, false if poll() must be used.
+   */
+  static bool begin();
+
+  /**
+   * @brief Disarm the hardware timer. Registered timers are kept and can be poll()ed.
+   */
+  static void end();
+
+  /**
+   * @brief Register a timer. Its timelapse is interpreted in microseconds.
+   * @param timer The timer to register.
+   * @return True on success, false if full, already registered or owned by a scheduler.
+   */
+  static bool add(timecontrol& timer);
+
+  /**
+   * @brief Unregister a timer.
+   * @param timer The timer to unregister.
+   * @return True if it was registered.
+   */
+  static bool remove(timecontrol& timer);
+
+  /**
+   * @brief Re-arm the hardware timer for the current earliest deadline.
+   * 
+   * Call it from loop() after stopping, resuming, resetting or changing the timelapse 
+   * of a registered timer. Changes made from its own callbacks are picked up automatically.
+   */
+  static void update();
+
+  /**
+   * @brief Fallback for boards without a backend (or before begin()): fire due timers.
+   * 
+   * Does nothing while the hardware backend is running.
+   */
+  static void poll();
+
+  /**
+   * @brief Check whether the hardware backend is running.
+   * @return True between a successful begin() and end().
+   */
+  static inline bool isHardware() {
+    return _running;
+  }
+
+  /**
+   * @brief Get the number of registered timers.
+   * @return The timer count.
+   */
+  static inline uint8_t size() {
+    return _size;
+  }
+
+  /**
+   * @brief Interrupt body: fire due timers and arm the next deadline.
+   * 
+   * Called by the backend's interrupt handler. Use poll() from sketch code instead.
+   */
+  static void serviceInterrupt();
+
+private:
+  static timecontrol* _timers[TIMEHIRES_MAX_TIMERS];  /**< Registered timers. */
+  static volatile uint8_t _size;                      /**< Number of registered timers. */
+  static bool _running;                               /**< Hardware backend armed by begin(). */
+#if defined(ESP32)
+  static esp_timer_handle_t _handle;                  /**< One-shot esp_timer. */
+  static void onTimer(void* argument);
+#endif
+
+  static void fireDue(bool inInterrupt);
+  static uint32_t nextDelay();
+  static void arm(uint32_t delay);
+  static void disarm();
+};
+
+#endif  // TIMEHIRES_H
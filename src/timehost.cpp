@@ -0,0 +1,34 @@
+/**
+ * @file timehost.cpp
+ * @brief Virtual clock and simulated interrupt lines for desktop builds. Empty when
+ * compiled by an Arduino core.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timehost.h"
+
+#if !defined(ARDUINO)
+
+uint64_t timehost::_micros = 0;
+uint64_t (*timehost::_source)() = nullptr;
+void (*timehost::_handlers[EXTERNAL_NUM_INTERRUPTS])(void) = {};
+uint8_t timehost::_pins[TIMEHOST_PINS] = {};
+
+bool timehost::trigger(uint8_t interrupt) {
+  if (interrupt >= EXTERNAL_NUM_INTERRUPTS || !_handlers[interrupt]) return false;
+  _handlers[interrupt]();
+  return true;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int) {
+  if (interrupt < EXTERNAL_NUM_INTERRUPTS) timehost::_handlers[interrupt] = handler;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+  if (interrupt < EXTERNAL_NUM_INTERRUPTS) timehost::_handlers[interrupt] = nullptr;
+}
+
+#endif  // !ARDUINO
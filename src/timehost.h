@@ -0,0 +1,244 @@
+/**
+ * @file timehost.h
+ * @brief Header file for the timehost class.
+ * This file declares the virtual clock and the subset of the Arduino API the library uses, 
+ * so that it builds and runs on a desktop compiler (ARDUINO not defined).
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEHOST_H
+#define TIMEHOST_H
+
+#if !defined(ARDUINO)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef EXTERNAL_NUM_INTERRUPTS
+#define EXTERNAL_NUM_INTERRUPTS 8  /**< Simulated interrupt lines, raised with timehost::trigger(). */
+#endif
+
+#ifndef TIMEHOST_PINS
+#define TIMEHOST_PINS 64  /**< Simulated digital pins, driven with timehost::setPin(). */
+#endif
+
+#define NOT_AN_INTERRUPT -1
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+/**
+ * @brief Virtual clock and interrupt simulator for desktop builds.
+ * 
+ * millis() and micros() read a 64-bit microsecond counter that only moves when the 
+ * program says so, truncated to 32 bits like on the boards. Simulations are therefore 
+ * deterministic and run as fast as the CPU allows, and rollovers can be reached 
+ * instantly: setMillis(0xFFFFF000) is 4 seconds before the 49.7-day millis() wrap, 
+ * setMicros(0xFFFFF000) 4 ms before the 71.6-minute micros() wrap.
+ * 
+ * setSource() replaces the virtual counter with any other clock (a wall clock for 
+ * real-time runs, a recorded trace, ...). Sleeping (idle(), sleepFor(), wait(), delay()) 
+ * advances the virtual clock instead of blocking. Digital pins are simulated levels: tests 
+ * drive inputs with setPin() and read outputs with getPin().
+ */
+class timehost {
+public:
+  /**
+   * @brief Get the current time of the active clock.
+   * @return Microseconds, on 64 bits.
+   */
+  static inline uint64_t now() {
+    return _source ? _source() : _micros;
+  }
+
+  /**
+   * @brief Move the virtual clock to an absolute time.
+   * @param us The new time in microseconds.
+   */
+  static inline void setMicros(uint64_t us) {
+    _micros = us;
+  }
+
+  /**
+   * @brief Move the virtual clock to an absolute time in milliseconds.
+   * @param ms The new time in milliseconds.
+   */
+  static inline void setMillis(uint64_t ms) {
+    _micros = ms * 1000;
+  }
+
+  /**
+   * @brief Advance the virtual clock.
+   * @param us The time to add in microseconds.
+   */
+  static inline void advanceMicros(uint64_t us) {
+    _micros += us;
+  }
+
+  /**
+   * @brief Advance the virtual clock in milliseconds.
+   * @param ms The time to add in milliseconds.
+   */
+  static inline void advanceMillis(uint64_t ms) {
+    _micros += ms * 1000;
+  }
+
+  /**
+   * @brief Use another clock than the virtual counter.
+   * @param source Function returning the time in microseconds, or nullptr for the virtual clock.
+   */
+  static inline void setSource(uint64_t (*source)()) {
+    _source = source;
+  }
+
+  /**
+   * @brief Run the handler attached to a simulated interrupt line, as the hardware would.
+   * @param interrupt The interrupt number (as returned by digitalPinToInterrupt()).
+   * @return True if a handler was attached and has run.
+   */
+  static bool trigger(uint8_t interrupt);
+
+  /**
+   * @brief Drive a simulated input pin, as read by digitalRead().
+   * @param pin The pin number.
+   * @param level HIGH or LOW.
+   */
+  static inline void setPin(uint8_t pin, uint8_t level) {
+    if (pin < TIMEHOST_PINS) _pins[pin] = level;
+  }
+
+  /**
+   * @brief Get the level of a simulated pin, as set by setPin() or digitalWrite().
+   * @param pin The pin number.
+   * @return HIGH or LOW (LOW for pins out of range).
+   */
+  static inline uint8_t getPin(uint8_t pin) {
+    return (pin < TIMEHOST_PINS) ? _pins[pin] : LOW;
+  }
+
+  /**
+   * @brief Let time pass while the "CPU" sleeps: one millisecond on the virtual clock.
+   */
+  static inline void idle() {
+    if (!_source) _micros += 1000;
+  }
+
+private:
+  static uint64_t _micros;                                     /**< Virtual time in microseconds. */
+  static uint64_t (*_source)();                                /**< Replacement clock, or nullptr. */
+  static void (*_handlers[EXTERNAL_NUM_INTERRUPTS])(void);     /**< Attached interrupt handlers. */
+  static uint8_t _pins[TIMEHOST_PINS];                         /**< Simulated pin levels. */
+
+  friend void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+  friend void detachInterrupt(uint8_t interrupt);
+};
+
+inline uint32_t millis() {
+  return (uint32_t)(timehost::now() / 1000);
+}
+
+inline uint32_t micros() {
+  return (uint32_t)timehost::now();
+}
+
+inline void delay(uint32_t ms) {
+  timehost::advanceMillis(ms);
+}
+
+inline void delayMicroseconds(uint32_t us) {
+  timehost::advanceMicros(us);
+}
+
+inline void yield() {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) timehost::setPin(pin, HIGH);  // Pulled up until driven low
+}
+
+inline int digitalRead(uint8_t pin) {
+  return timehost::getPin(pin);
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+  timehost::setPin(pin, level);
+}
+
+inline int digitalPinToInterrupt(uint8_t pin) {
+  return (pin < EXTERNAL_NUM_INTERRUPTS) ? pin : NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+/**
+ * @brief Minimal stand-in for the Arduino Print class: derive and implement write().
+ */
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+
+  size_t print(const char* text) {
+    return write((const uint8_t*)text, strlen(text));
+  }
+
+  size_t print(char c) {
+    return write((uint8_t)c);
+  }
+
+  size_t print(unsigned long value) {
+    char digits[20];
+    uint8_t n = 0;
+    do {
+      digits[n++] = '0' + value % 10;
+      value /= 10;
+    } while (value > 0);
+    size_t written = 0;
+    while (n > 0) written += write((uint8_t)digits[--n]);
+    return written;
+  }
+
+  size_t print(long value) {
+    if (value >= 0) return print((unsigned long)value);
+    return print('-') + print((unsigned long)(-(value + 1)) + 1);
+  }
+
+  size_t print(unsigned int value) {
+    return print((unsigned long)value);
+  }
+
+  size_t print(int value) {
+    return print((long)value);
+  }
+
+  size_t println() {
+    return print('\n');
+  }
+
+  template <class T>
+  size_t println(T value) {
+    return print(value) + println();
+  }
+};
+
+#endif  // !ARDUINO
+
+#endif  // TIMEHOST_H
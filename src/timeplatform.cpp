@@ -0,0 +1,136 @@
+/**
+ * @file timeplatform.cpp
+ * @brief Low-power idle and sleep primitives for AVR, ESP32 and SAMD, with a 
+ * portable yield() fallback for other cores, the critical section lock and the 
+ * hardware watchdog.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timeplatform.h"
+
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#elif defined(ESP32)
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <esp_task_wdt.h>
+#elif defined(ARDUINO_ARCH_RP2040)
+#include <hardware/watchdog.h>
+#endif
+
+volatile bool timeplatform::_wakeRequested = false;
+
+#if defined(ESP32)
+portMUX_TYPE timecriticalsection::_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t wakeModes[GPIO_NUM_MAX];  // attachInterrupt() mode of each wake pin, 0 if none
+
+// Light sleep only wakes on GPIO levels: arm each pin at the level it is not at now.
+static bool armWakePins() {
+  bool armed = false;
+  for (uint8_t pin = 0; pin < GPIO_NUM_MAX; pin++) {
+    if (!wakeModes[pin]) continue;
+    gpio_wakeup_enable((gpio_num_t)pin, digitalRead(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    armed = true;
+  }
+  if (armed) esp_sleep_enable_gpio_wakeup();
+  return armed;
+}
+
+// gpio_wakeup_enable() replaced the interrupt type set by attachInterrupt(): put it back.
+static void restoreWakePins() {
+  for (uint8_t pin = 0; pin < GPIO_NUM_MAX; pin++) {
+    if (!wakeModes[pin]) continue;
+    gpio_wakeup_disable((gpio_num_t)pin);
+    gpio_set_intr_type((gpio_num_t)pin, (gpio_int_type_t)wakeModes[pin]);
+  }
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+}
+#endif
+
+void timeplatform::idle() {
+#if defined(__AVR__)
+  set_sleep_mode(SLEEP_MODE_IDLE);  // Timers keep running, so millis() stays correct
+  sleep_mode();
+#elif defined(ESP32)
+  vTaskDelay(1);                    // Lets the idle task (and automatic light sleep) run
+#elif defined(ARDUINO_ARCH_SAMD)
+  __WFI();
+#elif !defined(ARDUINO)
+  timehost::idle();                 // Virtual clock: sleeping is what makes time pass
+#else
+  yield();
+#endif
+}
+
+void timeplatform::sleepFor(uint32_t duration, bool tickless) {
+  if (duration == 0) return;
+#if defined(ESP32)
+  if (tickless) {
+    esp_sleep_enable_timer_wakeup((uint64_t)duration * 1000);
+    bool pins = armWakePins();
+    if (!_wakeRequested) esp_light_sleep_start();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    if (pins) restoreWakePins();
+    return;
+  }
+#else
+  (void)tickless;  // Tick-driven platforms: the system tick is also the millis() timebase
+#endif
+  uint32_t start = millis();
+  while (!_wakeRequested && millis() - start < duration) idle();
+}
+
+void timeplatform::enableWakeInterrupt(uint8_t interrupt, uint8_t mode) {
+#if defined(ESP32)
+  if (interrupt < GPIO_NUM_MAX) wakeModes[interrupt] = mode;
+#else
+  (void)interrupt;
+  (void)mode;
+#endif
+}
+
+void timeplatform::disableWakeInterrupt(uint8_t interrupt) {
+#if defined(ESP32)
+  if (interrupt < GPIO_NUM_MAX) wakeModes[interrupt] = 0;
+#else
+  (void)interrupt;
+#endif
+}
+
+bool timeplatform::watchdogEnable(uint32_t timeout) {
+#if defined(__AVR__)
+  uint8_t prescaler = 0;                   // WDTO_15MS .. WDTO_8S are 15 ms << prescaler
+  uint8_t last = 7;                        // WDTO_2S on parts without the 4 s and 8 s settings
+#if defined(WDTO_8S)
+  last = WDTO_8S;
+#endif
+  while (prescaler < last && (15UL << (prescaler + 1)) <= timeout) prescaler++;
+  wdt_enable(prescaler);
+  return true;
+#elif defined(ESP32)
+  esp_err_t result = esp_task_wdt_add(NULL);
+  (void)timeout;
+  return result == ESP_OK || result == ESP_ERR_INVALID_ARG;  // Already subscribed
+#elif defined(ARDUINO_ARCH_RP2040)
+  watchdog_enable(timeout > 8388 ? 8388 : timeout, true);  // Paused while debugging
+  return true;
+#else
+  (void)timeout;
+  return false;
+#endif
+}
+
+void timeplatform::watchdogFeed() {
+#if defined(__AVR__)
+  wdt_reset();
+#elif defined(ESP32)
+  esp_task_wdt_reset();
+#elif defined(ARDUINO_ARCH_RP2040)
+  watchdog_update();
+#endif
+}
@@ -0,0 +1,223 @@
+/**
+ * @file timeplatform.h
+ * @brief Header file for the timeplatform class.
+ * This file declares the low-power helpers used to idle the MCU between timer deadlines,
+ * portable critical sections, the hardware watchdog and the core count of multicore parts.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEPLATFORM_H
+#define TIMEPLATFORM_H
+
+#include "timearduino.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+
+/**
+ * @brief Number of cores that may run library code concurrently.
+ */
+#ifndef TIMEPLATFORM_CORES
+#if defined(ESP32)
+#define TIMEPLATFORM_CORES portNUM_PROCESSORS
+#elif defined(ARDUINO_ARCH_RP2040)
+#define TIMEPLATFORM_CORES 2
+#else
+#define TIMEPLATFORM_CORES 1
+#endif
+#endif
+
+/**
+ * @brief Short critical section that restores the previous interrupt state on exit.
+ * 
+ * Unlike noInterrupts()/interrupts(), it can be nested and used from interrupt context. 
+ * Keep the protected code to a few instructions (copying or updating a handful of fields).
+ * 
+ * | Platform | Mechanism |
+ * | --- | --- |
+ * | AVR | Save `SREG`, `cli()` |
+ * | ESP32 | Shared spinlock (`portENTER_CRITICAL_SAFE`), also excludes the other core |
+ * | RP2040 | `save_and_disable_interrupts()` (local core) |
+ * | Other ARM | Save `PRIMASK`, `__disable_irq()` |
+ * | Others | `noInterrupts()` / `interrupts()` |
+ */
+class timecriticalsection {
+public:
+  inline timecriticalsection() {
+#if defined(__AVR__)
+    _state = SREG;
+    cli();
+#elif defined(ESP32)
+    portENTER_CRITICAL_SAFE(&_lock);
+#elif defined(ARDUINO_ARCH_RP2040)
+    _state = save_and_disable_interrupts();
+#elif defined(__arm__) && defined(ARDUINO)
+    _state = __get_PRIMASK();
+    __disable_irq();
+#else
+    noInterrupts();
+#endif
+  }
+
+  inline ~timecriticalsection() {
+#if defined(__AVR__)
+    SREG = _state;
+#elif defined(ESP32)
+    portEXIT_CRITICAL_SAFE(&_lock);
+#elif defined(ARDUINO_ARCH_RP2040)
+    restore_interrupts(_state);
+#elif defined(__arm__) && defined(ARDUINO)
+    __set_PRIMASK(_state);
+#else
+    interrupts();
+#endif
+  }
+
+  timecriticalsection(const timecriticalsection&) = delete;
+  timecriticalsection& operator=(const timecriticalsection&) = delete;
+
+private:
+#if defined(__AVR__)
+  uint8_t _state;   /**< Saved SREG. */
+#elif defined(ESP32)
+  static portMUX_TYPE _lock;  /**< Spinlock shared by all critical sections. */
+#elif defined(ARDUINO_ARCH_RP2040) || (defined(__arm__) && defined(ARDUINO))
+  uint32_t _state;  /**< Saved interrupt mask. */
+#endif
+};
+
+/**
+ * @brief Short critical section that only masks interrupts on the calling core.
+ * 
+ * Keeps other tasks and interrupts of the same core out, without spinning on a lock shared 
+ * with the other core. Enough for data that each core owns separately (one queue per core). 
+ * On single-core platforms and RP2040 it is the same as timecriticalsection; on ESP32 it 
+ * raises the interrupt level (`portSET_INTERRUPT_MASK_FROM_ISR`), which also stops the 
+ * local scheduler from switching tasks.
+ */
+class timelocalsection {
+public:
+#if defined(ESP32)
+  inline timelocalsection() : _state(portSET_INTERRUPT_MASK_FROM_ISR()) {}
+  inline ~timelocalsection() {
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(_state);
+  }
+#else
+  inline timelocalsection() {}
+#endif
+
+  timelocalsection(const timelocalsection&) = delete;
+  timelocalsection& operator=(const timelocalsection&) = delete;
+
+private:
+#if defined(ESP32)
+  UBaseType_t _state;            /**< Saved interrupt level. */
+#else
+  timecriticalsection _section;  /**< Interrupts are already masked per core. */
+#endif
+};
+
+/**
+ * @brief Platform-specific idle and sleep primitives.
+ * 
+ * | Platform | idle() | Tickless sleepFor() |
+ * | --- | --- | --- |
+ * | AVR | `SLEEP_MODE_IDLE`, woken by the Timer0 tick or any interrupt | Not available (Timer0 drives millis()), ticks instead |
+ * | ESP32 | One RTOS tick (`vTaskDelay`) | Light sleep woken by the timer or a wake interrupt pin |
+ * | SAMD | `WFI`, woken by SysTick or any interrupt | Not available, ticks instead |
+ * | Others | `yield()` | Not available, ticks instead |
+ * | Desktop (no ARDUINO) | Advances the timehost virtual clock by 1 ms | Not available, ticks instead |
+ */
+class timeplatform {
+public:
+  /**
+   * @brief Put the CPU in its lightest sleep state until the next interrupt (at most one tick).
+   */
+  static void idle();
+
+  /**
+   * @brief Sleep for up to a given duration, returning early if wake() is called.
+   * 
+   * When tickless is true and the platform supports it, the wake source is programmed 
+   * for the exact duration instead of waking on every system tick.
+   * 
+   * @param duration The maximum time to sleep in milliseconds.
+   * @param tickless True to reprogram the wake source for the whole duration.
+   */
+  static void sleepFor(uint32_t duration, bool tickless = false);
+
+  /**
+   * @brief Let an attached interrupt end a tickless sleepFor().
+   * 
+   * On ESP32 the pin becomes a GPIO light-sleep wake-up source, armed at the level opposite 
+   * to the one read just before sleeping, and its interrupt type is restored on wake-up. 
+   * Other platforms wake on any interrupt and ignore it.
+   * 
+   * @param interrupt The interrupt number given to attachInterrupt() (the GPIO on ESP32).
+   * @param mode The attachInterrupt() mode, restored after each light sleep.
+   */
+  static void enableWakeInterrupt(uint8_t interrupt, uint8_t mode);
+
+  /**
+   * @brief Stop an interrupt from ending a tickless sleepFor().
+   * @param interrupt The interrupt number given to enableWakeInterrupt().
+   */
+  static void disableWakeInterrupt(uint8_t interrupt);
+
+  /**
+   * @brief Get the core the caller runs on.
+   * @return The core index, 0 to TIMEPLATFORM_CORES - 1 (always 0 on single-core platforms).
+   */
+  static inline uint8_t core() {
+#if defined(ESP32) && (TIMEPLATFORM_CORES > 1)
+    return (uint8_t)xPortGetCoreID();
+#elif defined(ARDUINO_ARCH_RP2040)
+    return (uint8_t)get_core_num();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * @brief Start the MCU watchdog, which resets the board unless watchdogFeed() is called in time.
+   * 
+   * AVR rounds the timeout down to the nearest of 15 ms .. 8 s, RP2040 caps it at 8.3 s. 
+   * ESP32 subscribes the calling task to the task watchdog, whose timeout comes from the 
+   * sdkconfig. Other platforms have no portable watchdog and return false.
+   * 
+   * @param timeout The timeout in milliseconds.
+   * @return True if a hardware watchdog is running.
+   */
+  static bool watchdogEnable(uint32_t timeout);
+
+  /**
+   * @brief Restart the MCU watchdog timeout. Does nothing where watchdogEnable() fails.
+   */
+  static void watchdogFeed();
+
+  /**
+   * @brief Abort a sleepFor() in progress. Safe to call from interrupt context.
+   */
+  static inline void wake() {
+    _wakeRequested = true;
+  }
+
+  /**
+   * @brief Forget earlier wake() requests before deciding to sleep.
+   * 
+   * Call it before checking for pending work, so that a wake() raised between that check 
+   * and sleepFor() still aborts the sleep.
+   */
+  static inline void clearWake() {
+    _wakeRequested = false;
+  }
+
+private:
+  static volatile bool _wakeRequested;  /**< Set by wake(), cleared by clearWake(). */
+};
+
+#endif  // TIMEPLATFORM_H
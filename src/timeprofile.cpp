@@ -0,0 +1,57 @@
+/**
+ * @file timeprofile.cpp
+ * @brief Per-timer callback profiler: duration histogram, overruns, latency and the 
+ * Print& summary. Empty unless TIMECONTROL_PROFILER is 1.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timeprofile.h"
+
+#if TIMECONTROL_PROFILER
+
+void timeprofile::clear() {
+  _calls = 0;
+  _totalDuration = 0;
+  _maxDuration = 0;
+  _maxLateness = 0;
+  _overruns = 0;
+  memset(_histogram, 0, sizeof(_histogram));
+}
+
+void timeprofile::record(uint32_t duration, uint32_t period, uint32_t lateness) {
+  if (_calls < 0xFFFFFFFF) _calls++;
+  _totalDuration = (_totalDuration > 0xFFFFFFFF - duration) ? 0xFFFFFFFF : _totalDuration + duration;
+  if (duration > _maxDuration) _maxDuration = duration;
+  if (lateness > _maxLateness) _maxLateness = lateness;
+  if (period > 0 && duration > period && _overruns < 0xFFFF) _overruns++;
+  uint8_t bin = 0;
+  while (duration > 0 && bin < TIMECONTROL_PROFILER_BINS - 1) {  // Bit length, no division
+    duration >>= 1;
+    bin++;
+  }
+  if (_histogram[bin] < 0xFFFF) _histogram[bin]++;
+}
+
+size_t timeprofile::printTo(Print& out) const {
+  size_t n = out.print("calls=");
+  n += out.print(_calls);
+  n += out.print(" max=");
+  n += out.print(_maxDuration);
+  n += out.print("us mean=");
+  n += out.print(getMeanDuration());
+  n += out.print("us over=");
+  n += out.print(_overruns);
+  n += out.print(" late=");
+  n += out.print(_maxLateness);
+  n += out.print("us hist=");
+  for (uint8_t i = 0; i < TIMECONTROL_PROFILER_BINS; i++) {
+    if (i > 0) n += out.print(',');
+    n += out.print(_histogram[i]);
+  }
+  return n;
+}
+
+#endif  // TIMECONTROL_PROFILER
@@ -0,0 +1,138 @@
+/**
+ * @file timeprofile.h
+ * @brief Header file for the timeprofile class.
+ * This file declares the opt-in per-timer callback profiler: execution-time histogram, 
+ * overruns and fire latency. Nothing is compiled unless TIMECONTROL_PROFILER is 1.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEPROFILE_H
+#define TIMEPROFILE_H
+
+#include "timearduino.h"
+
+/**
+ * @brief Set to 1 (as a build flag, so the library sources see it) to profile every timer.
+ */
+#ifndef TIMECONTROL_PROFILER
+#define TIMECONTROL_PROFILER 0
+#endif
+
+/**
+ * @brief Number of log2 buckets in the callback duration histogram.
+ * 
+ * Bucket 0 counts calls under 1 us, bucket i counts [2^(i-1), 2^i) us and the last one 
+ * everything longer. The default (12) resolves up to 1 ms.
+ */
+#ifndef TIMECONTROL_PROFILER_BINS
+#define TIMECONTROL_PROFILER_BINS 12
+#endif
+
+#if TIMECONTROL_PROFILER
+
+/**
+ * @brief Callback execution statistics of one timer.
+ * 
+ * Filled by timecontrol around each callback dispatch (polled, interrupt or high-resolution 
+ * events). Durations and latencies are in microseconds, measured with micros(). Counters 
+ * saturate instead of wrapping.
+ */
+class timeprofile {
+public:
+  timeprofile() {
+    clear();
+  }
+
+  /**
+   * @brief Forget all samples.
+   */
+  void clear();
+
+  /**
+   * @brief Account for one callback dispatch.
+   * @param duration Time spent in the callbacks, in microseconds.
+   * @param period The timer period in microseconds, or 0 if it has none (interrupt events).
+   * @param lateness Fire time minus deadline, in microseconds.
+   */
+  void record(uint32_t duration, uint32_t period, uint32_t lateness);
+
+  /**
+   * @brief Write a one-line summary: calls, max/mean duration, overruns, max latency and histogram.
+   * @param out The destination.
+   * @return The number of characters written.
+   */
+  size_t printTo(Print& out) const;
+
+  /**
+   * @brief Get the number of measured dispatches.
+   * @return The call count.
+   */
+  inline uint32_t getCalls() const {
+    return _calls;
+  }
+
+  /**
+   * @brief Get the longest callback duration.
+   * @return The duration in microseconds.
+   */
+  inline uint32_t getMaxDuration() const {
+    return _maxDuration;
+  }
+
+  /**
+   * @brief Get the mean callback duration.
+   * @return The duration in microseconds, 0 without samples.
+   */
+  inline uint32_t getMeanDuration() const {
+    return _calls ? _totalDuration / _calls : 0;
+  }
+
+  /**
+   * @brief Get the number of dispatches that took longer than the timer period.
+   * @return The overrun count.
+   */
+  inline uint16_t getOverruns() const {
+    return _overruns;
+  }
+
+  /**
+   * @brief Get the largest delay between a deadline and the dispatch.
+   * @return The latency in microseconds.
+   */
+  inline uint32_t getMaxLateness() const {
+    return _maxLateness;
+  }
+
+  /**
+   * @brief Get one histogram bucket.
+   * @param bin The bucket index, below TIMECONTROL_PROFILER_BINS.
+   * @return The number of calls in that bucket.
+   */
+  inline uint16_t getBin(uint8_t bin) const {
+    return (bin < TIMECONTROL_PROFILER_BINS) ? _histogram[bin] : 0;
+  }
+
+  /**
+   * @brief Convert a millisecond value to microseconds, saturating at 0xFFFFFFFF.
+   * @param ms The time in milliseconds.
+   * @return The time in microseconds.
+   */
+  static inline uint32_t toMicros(uint32_t ms) {
+    return (ms < 4294967UL) ? ms * 1000 : 0xFFFFFFFF;
+  }
+
+private:
+  uint32_t _calls;                                  /**< Measured dispatches. */
+  uint32_t _totalDuration;                          /**< Sum of durations (saturating). */
+  uint32_t _maxDuration;                            /**< Longest duration. */
+  uint32_t _maxLateness;                            /**< Largest deadline-to-dispatch delay. */
+  uint16_t _overruns;                               /**< Dispatches longer than the period. */
+  uint16_t _histogram[TIMECONTROL_PROFILER_BINS];   /**< log2 buckets of the duration. */
+};
+
+#endif  // TIMECONTROL_PROFILER
+
+#endif  // TIMEPROFILE_H
@@ -0,0 +1,274 @@
+/**
+ * @file timescheduler.cpp
+ * @brief Registry that ticks many timecontrol instances from one captured timestamp. 
+ * Running timers are kept in a binary min-heap keyed by deadline, so loop() only 
+ * touches the timers that are due.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timescheduler.h"
+
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+static_assert(TIMESCHEDULER_COMMAND_QUEUE_SIZE >= 2 && TIMESCHEDULER_COMMAND_QUEUE_SIZE <= 128 && 
+              (TIMESCHEDULER_COMMAND_QUEUE_SIZE & (TIMESCHEDULER_COMMAND_QUEUE_SIZE - 1)) == 0,
+              "TIMESCHEDULER_COMMAND_QUEUE_SIZE must be a power of two between 2 and 128, or 0");
+#endif
+
+timeschedulerbase::timeschedulerbase(timecontrol** slots, timecontrol** heap, timecontrol** due, uint8_t capacity)
+  : _slots(slots), _heap(heap), _due(due), _capacity(capacity), _size(0), _armed(0), _pending(false), _windows(0), _maxSlack(0), 
+    _lateness(0), _maxLateness(0) {
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+  for (uint8_t i = 0; i < TIMEPLATFORM_CORES; i++) {
+    _commandHead[i] = 0;
+    _commandTail[i] = 0;
+  }
+#endif
+}
+
+bool timeschedulerbase::add(timecontrol& timer) {
+  if (timer._scheduler == this) return true;
+  if (timer._scheduler || timer._hires || _size >= _capacity) return false;
+  _slots[_size++] = &timer;
+  timer._scheduler = this;
+  update(timer);
+  return true;
+}
+
+bool timeschedulerbase::remove(timecontrol& timer) {
+  if (timer._scheduler != this) return false;
+  if (timer._heapIndex != TIMESCHEDULER_NONE) heapRemove(timer._heapIndex);
+  for (uint8_t i = 0; i < _size; i++) {
+    if (_slots[i] == &timer) {
+      _slots[i] = _slots[--_size];  // Order is not significant
+      break;
+    }
+  }
+  timer._scheduler = nullptr;
+  timer._rekeyPending = false;
+  return true;
+}
+
+uint8_t timeschedulerbase::tick(uint32_t now) {
+  timeclock::update(now);            // Keeps the 64-bit timebase ahead of the millis() rollover
+  timecontrol::processInterrupts();  // Deferred interrupt callbacks run here, in loop() context
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+  processCommands();                 // Changes posted by other tasks and cores
+#endif
+  if (_pending) processPending();
+  uint8_t fired = 0;
+  if (_armed == 0 || before(now, _heap[0]->_deadline)) return 0;  // Nothing has to fire yet
+  _lateness = now - _heap[0]->_deadline;
+  if (_lateness > _maxLateness) _maxLateness = _lateness;
+  uint8_t due = collectDue(now);
+  for (uint8_t i = 0; i < due; i++) {
+    timecontrol* timer = _due[i];
+    if (timer->_scheduler != this) continue;  // Removed by an earlier callback
+    if (timer->_timelapseHigh == 0 && before(now, timer->pMillis + timer->_timelapse)) {
+      update(*timer);                         // Reset by an earlier callback: its reference is past now
+      continue;
+    }
+    if (timer->elapsed(now)) {
+      fired++;                                // Fire path has already re-keyed the timer
+    } else {
+      update(*timer);                         // Stale key (timer changed from interrupt context)
+    }
+  }
+  return fired;
+}
+
+uint8_t timeschedulerbase::collectDue(uint32_t now) {
+  // Take the whole due set out of the heap before polling: a timer that is still due after 
+  // its poll (fixed rate, catching up) goes back into the heap and waits for the next tick, 
+  // so it cannot hold the top and starve the other due timers.
+  uint8_t due = 0;
+  if (_windows == 0) {
+    while (_armed > 0 && !before(now, _heap[0]->_deadline)) {
+      _due[due++] = _heap[0];
+      heapRemove(0);
+    }
+    return due;
+  }
+
+  // Timers with slack are keyed by the end of their window, deadline - slack is its start. 
+  // Only the top of the heap, up to now + the largest slack, can hold an open window: walk it 
+  // breadth first (children are never earlier than their parent), queueing in _due.
+  uint32_t horizon = now + _maxSlack;
+  uint8_t queued = 1;
+  _due[0] = _heap[0];
+  for (uint8_t read = 0; read < queued; read++) {
+    timecontrol* timer = _due[read];
+    uint16_t child = 2 * (uint16_t)timer->_heapIndex + 1;
+    for (uint16_t last = child + 2; child < last && child < _armed; child++) {
+      if (!before(horizon, _heap[child]->_deadline)) _due[queued++] = _heap[child];
+    }
+    bool open = timer->_slack > 0 && !before(now, timer->_deadline - timer->_slack);
+    if (open || !before(now, timer->_deadline)) _due[due++] = timer;  // Never ahead of read
+  }
+  for (uint8_t i = 0; i < due; i++) heapRemove(_due[i]->_heapIndex);
+  return due;
+}
+
+void timeschedulerbase::idle(bool tickless) {
+  timeplatform::clearWake();  // Before the checks, so an interrupt raised after them still wakes us
+  if (_pending || timecontrol::hasPendingInterrupts()) return;
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+  if (hasCommands()) return;
+#endif
+  uint32_t wait = nextDeadline();  // TIMESCHEDULER_NO_DEADLINE: sleep until an interrupt
+  if (wait == TIMESCHEDULER_NO_DEADLINE) tickless = false;  // Ticks keep checking for wake(), whatever the wake sources
+  if (wait > 0) timeplatform::sleepFor(wait, tickless);
+}
+
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+bool timeschedulerbase::post(timecontrol& timer, TimeCommand command, uint32_t value) {
+  if (timer._scheduler != this) return false;
+  {
+    timelocalsection section;  // Other tasks and interrupts of this core may post too
+    uint8_t core = timeplatform::core();
+    uint8_t head = _commandHead[core];
+    if ((uint8_t)(head - _commandTail[core]) >= TIMESCHEDULER_COMMAND_QUEUE_SIZE) return false;
+    commandentry& entry = _commands[core][head & (TIMESCHEDULER_COMMAND_QUEUE_SIZE - 1)];
+    entry.timer = &timer;
+    entry.value = value;
+    entry.type = command;
+    TIMECONTROL_BARRIER();  // Publish the entry before the new head
+    _commandHead[core] = head + 1;
+  }
+  timeplatform::wake();
+  return true;
+}
+
+bool timeschedulerbase::hasCommands() const {
+  for (uint8_t i = 0; i < TIMEPLATFORM_CORES; i++) {
+    if (_commandHead[i] != _commandTail[i]) return true;
+  }
+  return false;
+}
+
+void timeschedulerbase::processCommands() {
+  for (uint8_t core = 0; core < TIMEPLATFORM_CORES; core++) {
+    uint8_t tail = _commandTail[core];
+    while (tail != _commandHead[core]) {
+      TIMECONTROL_BARRIER();  // Read the entry only after observing the head
+      commandentry entry = _commands[core][tail & (TIMESCHEDULER_COMMAND_QUEUE_SIZE - 1)];
+      TIMECONTROL_BARRIER();  // Finish reading the entry before releasing the slot
+      _commandTail[core] = ++tail;
+      timecontrol& timer = *entry.timer;
+      if (timer._scheduler != this) continue;  // Removed after the command was posted
+      switch (entry.type) {
+        case CommandStop: timer.stop(); break;
+        case CommandResume: timer.resume(); break;
+        case CommandRestart: timer.restart(); break;
+        case CommandSetTimelapse: timer.setTimelapse(entry.value); break;
+        case CommandAdjustTimelapse: timer.adjustTimelapse((int32_t)entry.value); break;
+      }
+    }
+  }
+}
+#endif
+
+#if defined(ESP32)
+bool timeschedulerbase::runOnCore(uint8_t core, uint32_t stackSize, uint8_t priority) {
+  return xTaskCreatePinnedToCore(taskLoop, "timescheduler", stackSize, this, priority, nullptr, core) == pdPASS;
+}
+
+void timeschedulerbase::taskLoop(void* scheduler) {
+  timeschedulerbase* self = static_cast<timeschedulerbase*>(scheduler);
+  for (;;) {
+    self->tick();
+    self->idle();  // Until the next deadline, a posted command or an interrupt
+  }
+}
+#endif
+
+void timeschedulerbase::update(timecontrol& timer) {
+  uint8_t index = timer._heapIndex;
+  if (!timer._state) {
+    if (index != TIMESCHEDULER_NONE) heapRemove(index);
+    return;
+  }
+  uint32_t previous = timer._deadline;
+  if (timer._timelapseHigh > 0) {
+    uint32_t now = millis();                    // 64-bit timelapse: armed in steps the heap can order
+    uint32_t left = timer.remainingTime(now);
+    timer._deadline = now + ((left < TIMESCHEDULER_MAX_ARM) ? left : TIMESCHEDULER_MAX_ARM) + timer._slack;
+  } else {
+    timer._deadline = timer.pMillis + timer._timelapse + timer._slack;
+  }
+  bool windowed = timer._slack > 0;
+  if (windowed != timer._windowed) {  // Armed, or slack changed while armed
+    timer._windowed = windowed;
+    if (windowed) {
+      _windows++;
+    } else if (--_windows == 0) {
+      _maxSlack = 0;
+    }
+  }
+  if (windowed && timer._slack > _maxSlack) _maxSlack = timer._slack;
+  if (index == TIMESCHEDULER_NONE) {
+    index = _armed++;
+    _heap[index] = &timer;
+    timer._heapIndex = index;
+    siftUp(index);
+  } else if (before(timer._deadline, previous)) {
+    siftUp(index);
+  } else {
+    siftDown(index);
+  }
+}
+
+void timeschedulerbase::processPending() {
+  _pending = false;  // Cleared first so that a request raised during the scan is kept
+  for (uint8_t i = 0; i < _size; i++) {
+    if (_slots[i]->_rekeyPending) _slots[i]->reschedule();
+  }
+}
+
+void timeschedulerbase::heapRemove(uint8_t index) {
+  timecontrol* removed = _heap[index];
+  removed->_heapIndex = TIMESCHEDULER_NONE;
+  if (removed->_windowed) {
+    removed->_windowed = false;
+    if (--_windows == 0) _maxSlack = 0;  // Kept as an upper bound until the last one leaves
+  }
+  if (index == --_armed) return;
+  timecontrol* last = _heap[_armed];
+  _heap[index] = last;
+  last->_heapIndex = index;
+  if (index > 0 && before(last->_deadline, _heap[(index - 1) / 2]->_deadline)) {
+    siftUp(index);
+  } else {
+    siftDown(index);
+  }
+}
+
+void timeschedulerbase::siftUp(uint8_t index) {
+  timecontrol* timer = _heap[index];
+  while (index > 0) {
+    uint8_t parent = (index - 1) / 2;
+    if (!before(timer->_deadline, _heap[parent]->_deadline)) break;
+    _heap[index] = _heap[parent];
+    _heap[index]->_heapIndex = index;
+    index = parent;
+  }
+  _heap[index] = timer;
+  timer->_heapIndex = index;
+}
+
+void timeschedulerbase::siftDown(uint8_t index) {
+  timecontrol* timer = _heap[index];
+  while (true) {
+    uint16_t child = 2 * (uint16_t)index + 1;
+    if (child >= _armed) break;
+    if (child + 1 < _armed && before(_heap[child + 1]->_deadline, _heap[child]->_deadline)) child++;
+    if (!before(_heap[child]->_deadline, timer->_deadline)) break;
+    _heap[index] = _heap[child];
+    _heap[index]->_heapIndex = index;
+    index = child;
+  }
+  _heap[index] = timer;
+  timer->_heapIndex = index;
+}
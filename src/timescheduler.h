@@ -0,0 +1,335 @@
+/**
+ * @file timescheduler.h
+ * @brief Header file for the timescheduler class.
+ * This file declares a registry that polls many timecontrol instances from a single clock read, 
+ * dispatching them in deadline order through a binary min-heap.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMESCHEDULER_H
+#define TIMESCHEDULER_H
+
+#include "timecontrol.h"
+#include "timeplatform.h"
+
+/**
+ * @brief Number of commands each core can queue for a scheduler with post() (power of two, 2..128, 
+ * or 0 to leave the command queue out). Off by default on AVR to save RAM.
+ */
+#ifndef TIMESCHEDULER_COMMAND_QUEUE_SIZE
+#if defined(__AVR__)
+#define TIMESCHEDULER_COMMAND_QUEUE_SIZE 0
+#else
+#define TIMESCHEDULER_COMMAND_QUEUE_SIZE 8
+#endif
+#endif
+
+const uint32_t TIMESCHEDULER_NO_DEADLINE = 0xFFFFFFFF; /**< Returned by nextDeadline() when no timer is armed. */
+const uint32_t TIMESCHEDULER_MAX_ARM = 0x40000000;     /**< Longest wait armed at once for a 64-bit timelapse (12.4 days). */
+
+/**
+ * @brief Enumerates the operations other tasks or cores can post to a scheduler.
+ */
+enum TimeCommand {
+  CommandStop,             /**< stop() */
+  CommandResume,           /**< resume() */
+  CommandRestart,          /**< restart() */
+  CommandSetTimelapse,     /**< setTimelapse(value) */
+  CommandAdjustTimelapse   /**< adjustTimelapse((int32_t)value) */
+};
+
+/**
+ * @brief Capacity-independent part of the scheduler.
+ * 
+ * Registered timers are kept in a caller-provided slot array, and the running ones 
+ * are additionally ordered by deadline in a binary min-heap. A tick() therefore costs 
+ * one compare against the earliest deadline plus O(log N) per timer that is due, 
+ * instead of a check of every timer. Deadlines are compared with wrap-safe 32-bit 
+ * arithmetic, which holds as long as pending deadlines are less than ~24.8 days apart.
+ * 
+ * Timers with slack are keyed by the end of their tolerance window. Whenever a tick fires 
+ * something, the timers whose window is already open fire in that same tick; they are 
+ * found by walking the top of the heap up to the largest slack, not every registered 
+ * timer. Their events are batched onto fewer wakeups, and nextDeadline() and idle() 
+ * sleep longer.
+ * 
+ * All the logic is compiled once, whatever the capacity. Use timescheduler<N> to get 
+ * a scheduler with its own storage.
+ */
+class timeschedulerbase {
+public:
+  /**
+   * @brief Register a timer with the scheduler.
+   * 
+   * A running timer is armed immediately. Afterwards, setTimelapse(), adjustTimelapse(), 
+   * stop(), resume() and the other state-changing methods re-key the timer in the heap.
+   * 
+   * @param timer The timer to register.
+   * @return True if the timer was added (or was already registered), false if the scheduler 
+   * is full or the timer belongs to another scheduler or to timehires.
+   */
+  bool add(timecontrol& timer);
+
+  /**
+   * @brief Unregister a timer from the scheduler.
+   * @param timer The timer to remove.
+   * @return True if the timer was registered and has been removed, false otherwise.
+   */
+  bool remove(timecontrol& timer);
+
+  /**
+   * @brief Dispatch the due timers using a single millis() read.
+   * @return The number of timers that elapsed during this tick.
+   */
+  inline uint8_t tick() {
+    return tick(millis());
+  }
+
+  /**
+   * @brief Dispatch the due timers against a timestamp captured by the caller.
+   * 
+   * Only the timers whose deadline has been reached are touched. The due set is taken 
+   * before any of them is polled, and each due timer is polled exactly once per tick, so a 
+   * fixed-rate timer catching up on missed periods fires once per tick and the others are 
+   * not delayed. A due timer reset by an earlier callback of the same tick is re-keyed 
+   * instead of polled. Events queued by deferred interrupts are processed first 
+   * (see timecontrol::processInterrupts()), then the commands queued with post(). A timer with slack (timecontrol::setSlack()) 
+   * is due once its slack has passed, and it also fires in any tick that fires another 
+   * timer after its own timelapse has elapsed.
+   * 
+   * @param now The current time in milliseconds.
+   * @return The number of timers that elapsed during this tick.
+   */
+  uint8_t tick(uint32_t now);
+
+  /**
+   * @brief Get the time left before the soonest expiry across all armed timers.
+   * 
+   * Read in O(1) from the top of the deadline heap, without polling any timer, so it 
+   * can be queried as often as needed (sleep logic, telemetry).
+   * 
+   * @return The time in milliseconds until the earliest deadline, 0 if a timer is already 
+   * due, or TIMESCHEDULER_NO_DEADLINE if no timer is armed.
+   */
+  inline uint32_t nextDeadline() const {
+    return nextDeadline(millis());
+  }
+
+  /**
+   * @brief Get the time left before the soonest expiry against a captured timestamp.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds until the earliest deadline, 0 if a timer is already 
+   * due, or TIMESCHEDULER_NO_DEADLINE if no timer is armed.
+   */
+  inline uint32_t nextDeadline(uint32_t now) const {
+    if (_armed == 0) return TIMESCHEDULER_NO_DEADLINE;
+    uint32_t deadline = _heap[0]->_deadline;
+    return before(now, deadline) ? (deadline - now) : 0;
+  }
+
+  /**
+   * @brief Get the armed timer with the soonest deadline.
+   * @return The next timer to expire, or nullptr if no timer is armed.
+   */
+  inline timecontrol* nextTimer() const {
+    return (_armed > 0) ? _heap[0] : nullptr;
+  }
+
+  /**
+   * @brief Sleep until the earliest pending deadline or until an interrupt arrives.
+   * 
+   * Computes the time left before the earliest armed deadline and idles the MCU for that 
+   * long with the platform's sleep mode (see timeplatform). Returns immediately when a 
+   * timer is already due or deferred interrupt events are waiting; an interrupt attached 
+   * with timecontrol::attachInterrupt() ends the sleep early. With no armed timer it sleeps 
+   * until the next such interrupt. Call it at the end of loop(), after tick().
+   * 
+   * @param tickless True to program the wake source for the whole wait where supported 
+   * (ESP32 light sleep), instead of waking on every system tick. With no armed timer the 
+   * wait is always tick-driven.
+   */
+  void idle(bool tickless = false);
+
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+  /**
+   * @brief Queue an operation on a registered timer, to be applied by the scheduler's owner.
+   * 
+   * Timers, like the scheduler, are plain data: only the task that calls tick() (the owner 
+   * of this timer group) may change them directly. Other FreeRTOS tasks, the other core and 
+   * interrupts post their changes instead. Each core has its own single-producer ring, 
+   * filled with the local core's interrupts masked for a few instructions and drained at the 
+   * start of the next tick(), so cores never wait on each other. Commands from one 
+   * core are applied in order. A sleeping idle() is woken up.
+   * 
+   * @param timer The timer to change (registered with this scheduler).
+   * @param command The operation to apply.
+   * @param value The timelapse for CommandSetTimelapse, the signed adjustment for 
+   * CommandAdjustTimelapse, ignored otherwise.
+   * @return True if the command was queued, false if the timer belongs to another scheduler 
+   * or the calling core's queue is full.
+   */
+  bool post(timecontrol& timer, TimeCommand command, uint32_t value = 0);
+
+  /**
+   * @brief Check if posted commands are waiting for the next tick().
+   * @return True if any core's command queue is not empty.
+   */
+  bool hasCommands() const;
+#endif
+
+#if defined(ESP32)
+  /**
+   * @brief Run this scheduler in its own FreeRTOS task, pinned to a core.
+   * 
+   * The task loops on tick() and idle(); from then on, every change to the timers made 
+   * from another task must go through post(). Callbacks run in that task.
+   * 
+   * @param core The core to pin the task to (0 or 1).
+   * @param stackSize The task stack size in bytes.
+   * @param priority The FreeRTOS task priority.
+   * @return True if the task was created.
+   */
+  bool runOnCore(uint8_t core, uint32_t stackSize = 4096, uint8_t priority = 1);
+#endif
+
+  /**
+   * @brief Get the number of registered timers.
+   * @return The number of timers currently registered.
+   */
+  inline uint8_t size() const {
+    return _size;
+  }
+
+  /**
+   * @brief Get the number of armed (running) timers in the deadline heap.
+   * @return The number of timers currently waiting for their deadline.
+   */
+  inline uint8_t armed() const {
+    return _armed;
+  }
+
+  /**
+   * @brief Get the maximum number of timers the scheduler can hold.
+   * @return The scheduler capacity.
+   */
+  inline uint8_t capacity() const {
+    return _capacity;
+  }
+
+  /**
+   * @brief Get how late the last firing tick ran.
+   * 
+   * Measured from the earliest deadline (timelapse plus slack) to the tick timestamp. It 
+   * shows a loop() too slow for its timers, without the per-timer profiler.
+   * 
+   * @return The lateness in milliseconds, 0 before the first firing tick.
+   */
+  inline uint32_t getLateness() const {
+    return _lateness;
+  }
+
+  /**
+   * @brief Get the largest lateness of a firing tick since construction or clearLateness().
+   * @return The lateness in milliseconds.
+   */
+  inline uint32_t getMaxLateness() const {
+    return _maxLateness;
+  }
+
+  /**
+   * @brief Restart the lateness statistics.
+   */
+  inline void clearLateness() {
+    _lateness = 0;
+    _maxLateness = 0;
+  }
+
+  /**
+   * @brief Get a registered timer by position, to walk them all (telemetry, diagnostics).
+   * 
+   * Positions run from 0 to size() - 1 in registration order; remove() moves the last 
+   * timer into the freed position.
+   * 
+   * @param index The position.
+   * @return The timer, or nullptr if index is not below size().
+   */
+  inline timecontrol* getTimer(uint8_t index) const {
+    return (index < _size) ? _slots[index] : nullptr;
+  }
+
+protected:
+  timeschedulerbase(timecontrol** slots, timecontrol** heap, timecontrol** due, uint8_t capacity);  /**< Constructor with storage provided by the derived class. */
+
+private:
+  timecontrol** _slots;   /**< Registered timers. */
+  timecontrol** _heap;    /**< Armed timers, ordered as a min-heap on _deadline. */
+  timecontrol** _due;     /**< Timers taken out of the heap to be polled by the current tick. */
+  uint8_t _capacity;      /**< Number of available slots. */
+  uint8_t _size;          /**< Number of registered timers. */
+  uint8_t _armed;         /**< Number of timers in the heap. */
+  volatile bool _pending; /**< Set from interrupt context when some timer must be re-keyed. */
+  uint8_t _windows;       /**< Number of armed timers with slack. */
+  uint32_t _maxSlack;     /**< Upper bound of their slack, reset when none is armed. */
+  uint32_t _lateness;     /**< Lateness of the last firing tick. */
+  uint32_t _maxLateness;  /**< Largest lateness since clearLateness(). */
+
+#if TIMESCHEDULER_COMMAND_QUEUE_SIZE
+  /**
+   * @brief Entry of a command queue.
+   */
+  struct commandentry {
+    timecontrol* timer;  /**< Target timer. */
+    uint32_t value;      /**< Command argument. */
+    uint8_t type;        /**< TimeCommand. */
+  };
+
+  commandentry _commands[TIMEPLATFORM_CORES][TIMESCHEDULER_COMMAND_QUEUE_SIZE];  /**< One ring per producing core. */
+  volatile uint8_t _commandHead[TIMEPLATFORM_CORES];                              /**< Next write position (free running). */
+  volatile uint8_t _commandTail[TIMEPLATFORM_CORES];                              /**< Next read position (free running). */
+
+  void processCommands();
+#endif
+#if defined(ESP32)
+  static void taskLoop(void* scheduler);
+#endif
+
+  void update(timecontrol& timer);
+  void processPending();
+  uint8_t collectDue(uint32_t now);
+  void heapRemove(uint8_t index);
+  void siftUp(uint8_t index);
+  void siftDown(uint8_t index);
+
+  /**
+   * @brief Wrap-safe deadline ordering.
+   * @return True if deadline a comes before deadline b.
+   */
+  static inline bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+  }
+
+  friend class timecontrol;
+};
+
+/**
+ * @brief Scheduler with storage for a fixed number of timers (no dynamic memory).
+ * @tparam Capacity Maximum number of timers that can be registered (up to 254).
+ */
+template <uint8_t Capacity>
+class timescheduler : public timeschedulerbase {
+  static_assert(Capacity > 0 && Capacity < TIMESCHEDULER_NONE, "timescheduler capacity must be 1..254");
+
+public:
+  timescheduler()
+    : timeschedulerbase(_storage, _heapStorage, _dueStorage, Capacity) {}  /**< Default constructor. */
+
+private:
+  timecontrol* _storage[Capacity];      /**< Slot storage for registered timers. */
+  timecontrol* _heapStorage[Capacity];  /**< Heap storage for armed timers. */
+  timecontrol* _dueStorage[Capacity];   /**< Due set of the current tick. */
+};
+
+#endif  // TIMESCHEDULER_H
@@ -0,0 +1,50 @@
+/**
+ * @file timestopwatch.cpp
+ * @brief Implementation of the timestopwatch and timecountdown classes: pause, resume, 
+ * laps and the scheduler wake-up at expiry.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timestopwatch.h"
+
+void timestopwatch::stop(uint32_t now) {
+  if (!_running) return;
+  _origin = now - _origin;  // Now holds the time measured
+  _running = false;
+}
+
+void timestopwatch::resume(uint32_t now) {
+  if (_running) return;
+  _origin = now - _origin;  // Back to a reference that excludes the pause
+  _running = true;
+}
+
+uint32_t timestopwatch::lap(uint32_t now) {
+  uint32_t total = elapsed(now);
+  uint32_t time = total - _lap;
+  _lap = total;
+  return time;
+}
+
+void timecountdown::stop(uint32_t now) {
+  if (!(_flags & FlagRunning)) return;
+  _deadline = remaining(now);  // Now holds the time left
+  _flags &= ~FlagRunning;
+}
+
+void timecountdown::resume(uint32_t now) {
+  if (!(_flags & FlagStarted) || (_flags & FlagRunning)) return;
+  _deadline += now;
+  _flags |= FlagRunning;
+}
+
+bool timecountdown::wakeAtExpiry(timecontrol& timer) {
+  if (!(_flags & FlagRunning)) return false;
+  timer.setTimelapse(remaining());
+  timer.setRepeatCount(1);
+  timer.restart();
+  return true;
+}
@@ -0,0 +1,350 @@
+/**
+ * @file timestopwatch.h
+ * @brief Header file for the timestopwatch and timecountdown classes.
+ * This file declares lightweight stopwatch and countdown types that keep only a reference 
+ * time and work out laps, remaining time and expiry when they are queried.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMESTOPWATCH_H
+#define TIMESTOPWATCH_H
+
+#include "timecontrol.h"
+
+/**
+ * @brief Stopwatch with pause, split and lap times, in 12 bytes (9 on AVR).
+ * 
+ * Nothing needs to be called while it runs: the elapsed time is the distance to the stored 
+ * start reference. A pause stores the time accumulated so far in the same field, and a 
+ * resume moves the reference back by that amount (as timecontrol::pauseAndResumeLater() 
+ * does), so paused intervals are excluded. Holds up to 49.7 days.
+ */
+class timestopwatch {
+public:
+  /**
+   * @brief Construct a stopwatch at zero.
+   * @param running True to start it immediately.
+   */
+  explicit timestopwatch(bool running = false)
+    : _origin(running ? millis() : 0), _lap(0), _running(running) {}
+
+  /**
+   * @brief Start from zero, discarding the time and laps measured so far.
+   */
+  inline void start() {
+    start(millis());
+  }
+
+  /**
+   * @brief Same as start(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  inline void start(uint32_t now) {
+    _origin = now;
+    _lap = 0;
+    _running = true;
+  }
+
+  /**
+   * @brief Pause. The time measured so far is kept.
+   */
+  inline void stop() {
+    stop(millis());
+  }
+
+  /**
+   * @brief Same as stop(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  void stop(uint32_t now);
+
+  /**
+   * @brief Continue after stop(), from the time reached.
+   */
+  inline void resume() {
+    resume(millis());
+  }
+
+  /**
+   * @brief Same as resume(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  void resume(uint32_t now);
+
+  /**
+   * @brief Set the time and laps back to zero, keeping the running state.
+   */
+  inline void reset() {
+    reset(millis());
+  }
+
+  /**
+   * @brief Same as reset(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  inline void reset(uint32_t now) {
+    _origin = _running ? now : 0;
+    _lap = 0;
+  }
+
+  /**
+   * @brief Get the time measured, pauses excluded.
+   * @return The time in milliseconds since start().
+   */
+  inline uint32_t elapsed() const {
+    return elapsed(millis());
+  }
+
+  /**
+   * @brief Same as elapsed(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds since start().
+   */
+  inline uint32_t elapsed(uint32_t now) const {
+    return _running ? now - _origin : _origin;
+  }
+
+  /**
+   * @brief Get a split time: the time measured so far, without ending the lap.
+   * @return The time in milliseconds since start().
+   */
+  inline uint32_t split() const {
+    return split(millis());
+  }
+
+  /**
+   * @brief Same as split(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds since start().
+   */
+  inline uint32_t split(uint32_t now) const {
+    return elapsed(now);
+  }
+
+  /**
+   * @brief End the current lap and start the next one.
+   * @return The lap time in milliseconds, pauses excluded.
+   */
+  inline uint32_t lap() {
+    return lap(millis());
+  }
+
+  /**
+   * @brief Same as lap(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return The lap time in milliseconds, pauses excluded.
+   */
+  uint32_t lap(uint32_t now);
+
+  /**
+   * @brief Get the time of the lap in progress.
+   * @return The time in milliseconds since the last lap() (or start()).
+   */
+  inline uint32_t currentLap() const {
+    return currentLap(millis());
+  }
+
+  /**
+   * @brief Same as currentLap(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds since the last lap() (or start()).
+   */
+  inline uint32_t currentLap(uint32_t now) const {
+    return elapsed(now) - _lap;
+  }
+
+  /**
+   * @brief Check whether the stopwatch is running.
+   * @return True between start() or resume() and stop().
+   */
+  inline bool isRunning() const {
+    return _running;
+  }
+
+private:
+  uint32_t _origin;  /**< Start reference while running, time measured while paused. */
+  uint32_t _lap;     /**< Time measured at the last lap. */
+  bool _running;     /**< True while running. */
+};
+
+/**
+ * @brief Countdown with pause, in 12 bytes (9 on AVR), independent of any timecontrol.
+ * 
+ * Unlike timecontrol::countdown(), it does not take over a timer's timelapse and state, 
+ * and nothing polls it: the remaining time and expiry are worked out from the stored 
+ * deadline whenever they are queried. A completion callback needs the scheduler: 
+ * wakeAtExpiry() arms a one-shot timecontrol, whose callback runs when the countdown ends, 
+ * and idle() sleeps until then.
+ * 
+ * A running countdown must be queried within ~24.8 days of its deadline (wrap-safe 32-bit 
+ * compare); a paused one keeps its remaining time indefinitely.
+ */
+class timecountdown {
+public:
+  /**
+   * @brief Construct a stopped countdown.
+   * @param duration The duration in milliseconds.
+   */
+  explicit timecountdown(uint32_t duration = 0)
+    : _deadline(0), _duration(duration), _flags(0) {}
+
+  /**
+   * @brief Start (or restart) the countdown for its full duration.
+   */
+  inline void start() {
+    start(millis());
+  }
+
+  /**
+   * @brief Same as start(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  inline void start(uint32_t now) {
+    _deadline = now + _duration;
+    _flags = FlagStarted | FlagRunning;
+  }
+
+  /**
+   * @brief Pause, keeping the remaining time.
+   */
+  inline void stop() {
+    stop(millis());
+  }
+
+  /**
+   * @brief Same as stop(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  void stop(uint32_t now);
+
+  /**
+   * @brief Continue after stop(), with the remaining time.
+   */
+  inline void resume() {
+    resume(millis());
+  }
+
+  /**
+   * @brief Same as resume(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   */
+  void resume(uint32_t now);
+
+  /**
+   * @brief Abandon the countdown: it is neither running nor expired.
+   */
+  inline void cancel() {
+    _flags = 0;
+  }
+
+  /**
+   * @brief Get the time left.
+   * @return The time in milliseconds, 0 once expired, or the duration if not started.
+   */
+  inline uint32_t remaining() const {
+    return remaining(millis());
+  }
+
+  /**
+   * @brief Same as remaining(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds, 0 once expired, or the duration if not started.
+   */
+  inline uint32_t remaining(uint32_t now) const {
+    if (!(_flags & FlagStarted)) return _duration;
+    if (!(_flags & FlagRunning)) return _deadline;
+    return ((int32_t)(_deadline - now) > 0) ? _deadline - now : 0;
+  }
+
+  /**
+   * @brief Get the time counted down so far, pauses excluded.
+   * @return The time in milliseconds, at most the duration.
+   */
+  inline uint32_t elapsed() const {
+    return elapsed(millis());
+  }
+
+  /**
+   * @brief Same as elapsed(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds, at most the duration.
+   */
+  inline uint32_t elapsed(uint32_t now) const {
+    return _duration - remaining(now);
+  }
+
+  /**
+   * @brief Check whether the countdown has reached zero.
+   * @return True once started and expired, until start() or cancel().
+   */
+  inline bool expired() const {
+    return expired(millis());
+  }
+
+  /**
+   * @brief Same as expired(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return True once started and expired, until start() or cancel().
+   */
+  inline bool expired(uint32_t now) const {
+    return (_flags & FlagStarted) && remaining(now) == 0;
+  }
+
+  /**
+   * @brief Check whether the countdown is counting.
+   * @return True if started, not paused and not expired.
+   */
+  inline bool isRunning() const {
+    return isRunning(millis());
+  }
+
+  /**
+   * @brief Same as isRunning(), against a timestamp captured by the caller.
+   * @param now The current time in milliseconds.
+   * @return True if started, not paused and not expired.
+   */
+  inline bool isRunning(uint32_t now) const {
+    return (_flags & FlagRunning) && remaining(now) > 0;
+  }
+
+  /**
+   * @brief Arm a one-shot timer to elapse when the countdown ends.
+   * 
+   * Registered with a timescheduler, the timer runs its callback at expiry and idle() 
+   * sleeps until then. The timer does not follow later stop(), resume() or start() calls: 
+   * call wakeAtExpiry() again after resuming, and stop the timer when pausing.
+   * 
+   * @param timer The timer to arm (its timelapse and repeat count are overwritten).
+   * @return False if the countdown is not running (timer unchanged).
+   */
+  bool wakeAtExpiry(timecontrol& timer);
+
+  /**
+   * @brief Set the duration used by the next start() (a running countdown keeps its deadline).
+   * @param duration The duration in milliseconds.
+   */
+  inline void setDuration(uint32_t duration) {
+    _duration = duration;
+  }
+
+  /**
+   * @brief Get the duration.
+   * @return The duration in milliseconds.
+   */
+  inline uint32_t getDuration() const {
+    return _duration;
+  }
+
+private:
+  static const uint8_t FlagStarted = 0x01;  /**< start() called since construction or cancel(). */
+  static const uint8_t FlagRunning = 0x02;  /**< Counting (not paused). */
+
+  uint32_t _deadline;  /**< Deadline while running, remaining time while paused. */
+  uint32_t _duration;  /**< Full duration. */
+  uint8_t _flags;      /**< FlagStarted and FlagRunning. */
+};
+
+#endif  // TIMESTOPWATCH_H
@@ -0,0 +1,99 @@
+/**
+ * @file timetelemetry.cpp
+ * @brief Implementation of the timetelemetry class: record encoding, incremental output 
+ * and the running checksum.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timetelemetry.h"
+
+timetelemetry::timetelemetry(timeschedulerbase& scheduler)
+  : _scheduler(scheduler), _timers(0), _position(2), _sum1(0), _sum2(0) {}
+
+void timetelemetry::begin() {
+  _timers = _scheduler.size();
+  _position = 0;
+  _sum1 = 0;
+  _sum2 = 0;
+}
+
+size_t timetelemetry::read(uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (!isDone() && size - n >= recordSize()) n += encode(buffer + n);
+  return n;
+}
+
+size_t timetelemetry::writeTo(Print& out, uint8_t records) {
+  uint8_t record[TIMETELEMETRY_TIMER_SIZE];  // The largest record
+  size_t n = 0;
+  while (records-- > 0 && !isDone()) n += out.write(record, encode(record));
+  return n;
+}
+
+uint8_t timetelemetry::recordSize() const {
+  if (_position == 0) return TIMETELEMETRY_HEADER_SIZE;
+  return (_position <= _timers) ? TIMETELEMETRY_TIMER_SIZE : TIMETELEMETRY_TRAILER_SIZE;
+}
+
+uint8_t timetelemetry::encode(uint8_t* record) {
+  uint8_t* out = record;
+  if (_position == 0) {
+    uint32_t now = millis();
+    out = put16(out, TIMETELEMETRY_MAGIC);
+    *out++ = TIMETELEMETRY_VERSION;
+    *out++ = TIMECONTROL_PROFILER ? 0x01 : 0x00;
+    *out++ = _timers;
+    *out++ = _scheduler.armed();
+    out = put32(out, now);
+    out = put32(out, _scheduler.nextDeadline(now));
+    out = put32(out, _scheduler.getLateness());
+    out = put32(out, _scheduler.getMaxLateness());
+  } else if (_position <= _timers) {
+    uint8_t index = (uint8_t)(_position - 1);
+    const timecontrol* timer = _scheduler.getTimer(index);
+    if (timer) {
+      timesnapshot state = timer->snapshot();
+      *out++ = index;
+      *out++ = (state.running ? 0x01 : 0) | (timer->isFixedRate() ? 0x02 : 0) | (timer->isOverdue() ? 0x04 : 0);
+      out = put32(out, timer->getTimelapse());
+      out = put32(out, state.count);
+      out = put32(out, state.lastElapsedTime);
+      out = put32(out, timer->getAverageElapsedTime(TIMECONTROL_HISTORY_SIZE));
+      out = put32(out, timer->getMinElapsedTime());
+      out = put32(out, timer->getMaxElapsedTime());
+      out = put32(out, timer->getMissedTicks());
+#if TIMECONTROL_PROFILER
+      const timeprofile& profile = timer->getProfile();
+      out = put32(out, profile.getCalls());
+      out = put32(out, profile.getMaxDuration());
+      out = put32(out, profile.getMeanDuration());
+      out = put16(out, profile.getOverruns());
+      out = put32(out, profile.getMaxLateness());
+#endif
+    } else {  // Removed since begin(): an empty record keeps the layout fixed
+      memset(out, 0, TIMETELEMETRY_TIMER_SIZE);
+      *out = index;
+      out += TIMETELEMETRY_TIMER_SIZE;
+    }
+  } else {
+    out = put16(out, (uint16_t)((_sum2 << 8) | _sum1));
+    _position++;
+    return TIMETELEMETRY_TRAILER_SIZE;
+  }
+  uint8_t length = out - record;
+  accumulate(record, length);
+  _position++;
+  return length;
+}
+
+void timetelemetry::accumulate(const uint8_t* data, uint8_t length) {
+  while (length-- > 0) {  // Fletcher-16, as in timecontrol::save(), without the modulo
+    _sum1 += *data++;
+    if (_sum1 >= 255) _sum1 -= 255;  // Both sums stay below 510: one subtract reduces them
+    _sum2 += _sum1;
+    if (_sum2 >= 255) _sum2 -= 255;
+  }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file timetelemetry.h
+ * @brief Header file for the timetelemetry class.
+ * This file declares an incremental, packed binary snapshot of the statistics of every 
+ * timer registered with a scheduler, written to a caller buffer or a Print stream.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMETELEMETRY_H
+#define TIMETELEMETRY_H
+
+#include "timescheduler.h"
+
+const uint16_t TIMETELEMETRY_MAGIC = 0x5443;  /**< First two bytes of a snapshot ("CT" on the wire, little-endian). */
+const uint8_t TIMETELEMETRY_VERSION = 2;      /**< Format version, bumped on layout changes. */
+const uint8_t TIMETELEMETRY_HEADER_SIZE = 22; /**< Bytes in the header record. */
+#if TIMECONTROL_PROFILER
+const uint8_t TIMETELEMETRY_TIMER_SIZE = 48;  /**< Bytes in a timer record, profile included. */
+#else
+const uint8_t TIMETELEMETRY_TIMER_SIZE = 30;  /**< Bytes in a timer record. */
+#endif
+const uint8_t TIMETELEMETRY_TRAILER_SIZE = 2; /**< Bytes in the trailer record (checksum). */
+
+/**
+ * @brief Producer of compact binary statistics snapshots for fleet monitoring.
+ * 
+ * A snapshot is a header, one fixed-size record per registered timer and a Fletcher-16 
+ * trailer, all little-endian with no padding. Records are encoded with shifts and byte 
+ * stores (no text formatting), and the snapshot is produced a few records per call, so a 
+ * dump spread over several loop() iterations never causes a latency spike.
+ * 
+ * | Record | Fields |
+ * | --- | --- |
+ * | Header | u16 magic, u8 version, u8 flags (bit 0: profile fields present), u8 timers, u8 armed, u32 millis(), u32 nextDeadline(), u32 scheduler lateness, u32 max scheduler lateness (ms) |
+ * | Timer | u8 index, u8 flags (bit 0 running, bit 1 fixed rate, bit 2 overdue), u32 timelapse, u32 count, u32 last elapsed, u32 average (history window), u32 min, u32 max, u32 missed ticks |
+ * | Profile (TIMECONTROL_PROFILER) | Appended to each timer: u32 calls, u32 max duration (us), u32 mean duration (us), u16 overruns, u32 max lateness (us) |
+ * | Trailer | u16 Fletcher-16 of every byte before it |
+ * 
+ * The header always reports how late the scheduler ticks run (timeschedulerbase::getLateness()), 
+ * and each timer its missed ticks and overdue flag. Callback durations, per-timer overruns and 
+ * per-timer lateness need the profiler (TIMECONTROL_PROFILER as a build flag). 
+ * 
+ * Count, last elapsed time and the running flag come from timecontrol::snapshot(), so they 
+ * are consistent even for timers driven by interrupts. Timers added or removed during a 
+ * snapshot may be reported twice or skipped; the header count is the one seen by begin().
+ */
+class timetelemetry {
+public:
+  /**
+   * @brief Construct a producer for the timers of a scheduler.
+   * @param scheduler The scheduler whose timers are reported.
+   */
+  explicit timetelemetry(timeschedulerbase& scheduler);
+
+  /**
+   * @brief Start a new snapshot, abandoning the one in progress.
+   */
+  void begin();
+
+  /**
+   * @brief Encode the next records into a buffer, whole records only.
+   * @param buffer The destination.
+   * @param size The buffer size in bytes (at least TIMETELEMETRY_TIMER_SIZE to make progress).
+   * @return The number of bytes written, 0 once the snapshot is complete.
+   */
+  size_t read(uint8_t* buffer, size_t size);
+
+  /**
+   * @brief Stream the next records to a Print destination (Serial, a socket, a file).
+   * @param out The destination.
+   * @param records The maximum number of records to write in this call.
+   * @return The number of bytes written, 0 once the snapshot is complete.
+   */
+  size_t writeTo(Print& out, uint8_t records = 1);
+
+  /**
+   * @brief Check whether the snapshot has been produced completely.
+   * @return True after the trailer, until the next begin().
+   */
+  inline bool isDone() const {
+    return _position > _timers + 1;
+  }
+
+  /**
+   * @brief Get the size of a complete snapshot, as started by begin().
+   * @return The number of bytes.
+   */
+  inline size_t size() const {
+    return TIMETELEMETRY_HEADER_SIZE + (size_t)_timers * TIMETELEMETRY_TIMER_SIZE + TIMETELEMETRY_TRAILER_SIZE;
+  }
+
+private:
+  timeschedulerbase& _scheduler;  /**< Source of the timers. */
+  uint8_t _timers;                /**< Timers in the snapshot, from begin(). */
+  uint16_t _position;             /**< 0 header, 1.._timers timer records, then the trailer. */
+  uint16_t _sum1;                 /**< Fletcher-16 running sums. */
+  uint16_t _sum2;
+
+  uint8_t recordSize() const;
+  uint8_t encode(uint8_t* record);
+  void accumulate(const uint8_t* data, uint8_t length);
+
+  static inline uint8_t* put16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+  }
+
+  static inline uint8_t* put32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+  }
+};
+
+#endif  // TIMETELEMETRY_H
@@ -0,0 +1,91 @@
+/**
+ * @file timewatchdog.cpp
+ * @brief Implementation of the timewatchdog supervisor: cached earliest deadline, 
+ * stall reporting and hardware watchdog feeding.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#include "timewatchdog.h"
+
+timewatchdogbase::timewatchdogbase(entry* entries, uint8_t capacity)
+  : _entries(entries), _capacity(capacity), _size(0), _earliest(TIMEWATCHDOG_NONE), _stalled(0),
+    _hardware(false), _feedOnStall(false), _callback(nullptr) {}
+
+uint8_t timewatchdogbase::add(uint32_t timeout) {
+  if (_size >= _capacity) return TIMEWATCHDOG_NONE;
+  uint8_t id = _size++;
+  entry& task = _entries[id];
+  task.timeout = timeout;
+  task.stalled = false;
+  task.active = false;
+  kick(id, millis());
+  return id;
+}
+
+void timewatchdogbase::kick(uint8_t id, uint32_t now) {
+  if (id >= _size) return;
+  entry& task = _entries[id];
+  task.deadline = now + task.timeout;
+  if (task.stalled) {
+    task.stalled = false;
+    _stalled--;
+  }
+  task.active = true;
+
+  // Only the task holding the earliest deadline can move it later and force a scan
+  if (id == _earliest) {
+    findEarliest();
+  } else if (_earliest == TIMEWATCHDOG_NONE || before(task.deadline, _entries[_earliest].deadline)) {
+    _earliest = id;
+  }
+}
+
+void timewatchdogbase::suspend(uint8_t id) {
+  if (id >= _size) return;
+  entry& task = _entries[id];
+  task.active = false;
+  if (task.stalled) {
+    task.stalled = false;
+    _stalled--;
+  }
+  if (id == _earliest) findEarliest();
+}
+
+void timewatchdogbase::setTimeout(uint8_t id, uint32_t timeout) {
+  if (id < _size) _entries[id].timeout = timeout;
+}
+
+bool timewatchdogbase::check(uint32_t now) {
+  // The single compare: nothing can be late before the earliest deadline
+  if (_earliest != TIMEWATCHDOG_NONE && before(_entries[_earliest].deadline, now)) {
+    for (uint8_t id = 0; id < _size; id++) {
+      entry& task = _entries[id];
+      if (!task.active || task.stalled || !before(task.deadline, now)) continue;
+      task.stalled = true;
+      _stalled++;
+      if (_callback) _callback(id, now - task.deadline);
+    }
+    findEarliest();
+  }
+
+  if (_hardware && (_stalled == 0 || _feedOnStall)) timeplatform::watchdogFeed();
+  return _stalled == 0;
+}
+
+bool timewatchdogbase::enableHardware(uint32_t timeout, bool feedOnStall) {
+  _feedOnStall = feedOnStall;
+  _hardware = timeplatform::watchdogEnable(timeout);
+  return _hardware;
+}
+
+void timewatchdogbase::findEarliest() {
+  _earliest = TIMEWATCHDOG_NONE;
+  for (uint8_t id = 0; id < _size; id++) {
+    const entry& task = _entries[id];
+    if (!task.active || task.stalled) continue;
+    if (_earliest == TIMEWATCHDOG_NONE || before(task.deadline, _entries[_earliest].deadline)) _earliest = id;
+  }
+}
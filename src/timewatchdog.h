@@ -0,0 +1,212 @@
+/**
+ * @file timewatchdog.h
+ * @brief Header file for the timewatchdog class.
+ * This file declares a supervisor that tracks a kick-by deadline for many tasks, checks 
+ * them all with one compare per loop and feeds the hardware watchdog while none stalls.
+ * @author ATphonOS 
+ * @version v1.0.0
+ * @date 2024
+ * MIT license
+ */
+
+#ifndef TIMEWATCHDOG_H
+#define TIMEWATCHDOG_H
+
+#include "timeplatform.h"
+
+const uint8_t TIMEWATCHDOG_NONE = 0xFF;              /**< Returned by add() when the supervisor is full. */
+const uint32_t TIMEWATCHDOG_NO_DEADLINE = 0xFFFFFFFF; /**< Returned by nextDeadline() when no task is supervised. */
+
+/**
+ * @brief Capacity-independent part of the watchdog supervisor.
+ * 
+ * Each supervised task gets an id from add() and must call kick() at least once per 
+ * timeout. The earliest kick-by deadline is cached, so check() costs a single compare 
+ * while everything is on time. Only a kick of the task that holds the earliest deadline, 
+ * or an actual miss, scans the entries. A task that misses its deadline is reported once 
+ * through the stall callback, with how late it is, and stays stalled until it kicks again.
+ * 
+ * With enableHardware(), check() also feeds the MCU watchdog, but only while no task is 
+ * stalled: a stuck task then resets the board, after the callback had a chance to log it. 
+ * Deadlines use wrap-safe 32-bit arithmetic (timeouts below ~24.8 days).
+ * 
+ * Use timewatchdog<N> to get a supervisor with its own storage.
+ */
+class timewatchdogbase {
+public:
+  typedef void (*stallcallback)(uint8_t id, uint32_t overdue);  /**< Stall callback signature. */
+
+  /**
+   * @brief Start supervising a task. Its first deadline is one timeout from now.
+   * @param timeout Maximum time between two kicks, in milliseconds.
+   * @return The task id, or TIMEWATCHDOG_NONE if the supervisor is full.
+   */
+  uint8_t add(uint32_t timeout);
+
+  /**
+   * @brief Report that a task is alive: its deadline moves one timeout ahead.
+   * @param id The task id returned by add().
+   */
+  inline void kick(uint8_t id) {
+    kick(id, millis());
+  }
+
+  /**
+   * @brief Report that a task is alive, against a timestamp captured by the caller.
+   * @param id The task id.
+   * @param now The current time in milliseconds.
+   */
+  void kick(uint8_t id, uint32_t now);
+
+  /**
+   * @brief Stop supervising a task until its next kick().
+   * @param id The task id.
+   */
+  void suspend(uint8_t id);
+
+  /**
+   * @brief Change the timeout of a task. Takes effect at its next kick().
+   * @param id The task id.
+   * @param timeout Maximum time between two kicks, in milliseconds.
+   */
+  void setTimeout(uint8_t id, uint32_t timeout);
+
+  /**
+   * @brief Check every task and feed the hardware watchdog if none has stalled.
+   * @return True if all tasks are on time.
+   */
+  inline bool check() {
+    return check(millis());
+  }
+
+  /**
+   * @brief Check every task against a timestamp captured by the caller.
+   * 
+   * O(1) while the earliest deadline has not passed. Otherwise the late tasks are marked 
+   * stalled and reported through the callback, once per stall.
+   * 
+   * @param now The current time in milliseconds.
+   * @return True if all tasks are on time.
+   */
+  bool check(uint32_t now);
+
+  /**
+   * @brief Set the function told about each stall.
+   * @param callback Function receiving the task id and how late it is, in milliseconds.
+   */
+  inline void setCallback(stallcallback callback) {
+    _callback = callback;
+  }
+
+  /**
+   * @brief Feed the MCU watchdog from check() while no task is stalled.
+   * 
+   * | Platform | Watchdog | Timeout |
+   * | --- | --- | --- |
+   * | AVR | `wdt_enable()` / `wdt_reset()` | Largest of 15 ms .. 8 s not above the request |
+   * | ESP32 | Task watchdog for the calling task (`esp_task_wdt_add()`) | From the sdkconfig |
+   * | RP2040 | `watchdog_enable()` / `watchdog_update()` | Up to 8.3 s |
+   * | Others | None: returns false | |
+   * 
+   * @param timeout The hardware timeout in milliseconds (longer than the check interval).
+   * @param feedOnStall True to keep feeding after a stall (report only, no reset).
+   * @return True if a hardware watchdog is available and running.
+   */
+  bool enableHardware(uint32_t timeout, bool feedOnStall = false);
+
+  /**
+   * @brief Check if a task is stalled.
+   * @param id The task id.
+   * @return True if the task missed its deadline and has not kicked since.
+   */
+  inline bool isStalled(uint8_t id) const {
+    return id < _size && _entries[id].stalled;
+  }
+
+  /**
+   * @brief Get the number of stalled tasks.
+   * @return The tasks that missed their deadline and have not kicked since.
+   */
+  inline uint8_t stalled() const {
+    return _stalled;
+  }
+
+  /**
+   * @brief Get the time left before the earliest deadline.
+   * @param now The current time in milliseconds.
+   * @return The time in milliseconds, 0 if it has passed, or TIMEWATCHDOG_NO_DEADLINE if no 
+   * task is supervised.
+   */
+  inline uint32_t nextDeadline(uint32_t now) const {
+    if (_earliest == TIMEWATCHDOG_NONE) return TIMEWATCHDOG_NO_DEADLINE;
+    uint32_t deadline = _entries[_earliest].deadline;
+    return before(now, deadline) ? (deadline - now) : 0;
+  }
+
+  /**
+   * @brief Get the number of tasks added.
+   * @return The number of ids in use.
+   */
+  inline uint8_t size() const {
+    return _size;
+  }
+
+  /**
+   * @brief Get the maximum number of tasks.
+   * @return The supervisor capacity.
+   */
+  inline uint8_t capacity() const {
+    return _capacity;
+  }
+
+protected:
+  /**
+   * @brief State of one supervised task.
+   */
+  struct entry {
+    uint32_t deadline;  /**< Kick-by time. */
+    uint32_t timeout;   /**< Time allowed between kicks. */
+    bool active;        /**< Supervised (false after suspend()). */
+    bool stalled;       /**< Missed its deadline, not kicked since. */
+  };
+
+  timewatchdogbase(entry* entries, uint8_t capacity);  /**< Constructor with storage provided by the derived class. */
+
+private:
+  entry* _entries;          /**< Task entries, indexed by id. */
+  uint8_t _capacity;        /**< Number of available entries. */
+  uint8_t _size;            /**< Number of ids handed out. */
+  uint8_t _earliest;        /**< Active, non-stalled task with the earliest deadline, or TIMEWATCHDOG_NONE. */
+  uint8_t _stalled;         /**< Number of stalled tasks. */
+  bool _hardware;           /**< True once enableHardware() succeeded. */
+  bool _feedOnStall;        /**< True to feed the hardware watchdog despite stalls. */
+  stallcallback _callback;  /**< Stall callback, or nullptr. */
+
+  void findEarliest();
+
+  /**
+   * @brief Wrap-safe deadline ordering.
+   * @return True if deadline a comes before deadline b.
+   */
+  static inline bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+  }
+};
+
+/**
+ * @brief Watchdog supervisor with storage for a fixed number of tasks (no dynamic memory).
+ * @tparam Capacity Maximum number of supervised tasks (up to 254).
+ */
+template <uint8_t Capacity>
+class timewatchdog : public timewatchdogbase {
+  static_assert(Capacity > 0 && Capacity < TIMEWATCHDOG_NONE, "timewatchdog capacity must be 1..254");
+
+public:
+  timewatchdog()
+    : timewatchdogbase(_storage, Capacity) {}  /**< Default constructor. */
+
+private:
+  entry _storage[Capacity];  /**< Entry storage. */
+};
+
+#endif  // TIMEWATCHDOG_H